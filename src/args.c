@@ -10,11 +10,20 @@
 
 void print_usage(const char *prog) {
     fprintf(stderr,
-        "Použití: %s -s server [-p port] -f filter_file\n"
+        "Použití: %s -s server [-p port] -f filter_file [-z zone_file] [-r qps] [-R rps]\n"
+        "          [-t ms [-S n] [-l log_file]] [-u socket_path]\n"
         "\nPopis parametrů:\n"
         "  -s server        IP adresa nebo doménové jméno DNS serveru\n"
         "  -p port          Port DNS serveru (výchozí 53)\n"
-        "  -f filter_file   Soubor obsahující nežádoucí domény\n",
+        "  -f filter_file   Soubor obsahující nežádoucí domény\n"
+        "  -z zone_file     Soubor s lokálními záznamy A/AAAA/CNAME\n"
+        "  -r qps           Limit dotazů za sekundu na síť klienta (výchozí bez limitu)\n"
+        "  -R rps           Limit stejných odpovědí za sekundu na síť klienta (výchozí bez limitu)\n"
+        "  -t ms            Měření dotazů, zápis dotazů pomalejších než ms do logu\n"
+        "  -S n             Měřit jen každý n-tý dotaz (výchozí 1)\n"
+        "  -l log_file      Soubor pro log pomalých dotazů (výchozí stderr)\n"
+        "  -u socket_path   Řídicí Unix socket pro předání naslouchajícího socketu\n"
+        "                   nové instanci (aktualizace bez výpadku)\n",
         prog
     );
 }
@@ -22,7 +31,15 @@ void print_usage(const char *prog) {
 bool parse_args(int argc, char **argv, Args *out) {
     out->server = NULL;
     out->filter_file = NULL;
+    out->zone_file = NULL;
     out->port = 53; // default port
+    out->rate_limit = 0;
+    out->response_rate_limit = 0;
+    out->slow_ms = -1; // tracing off
+    out->trace_sample = 1;
+    out->slow_log = NULL;
+    out->control_path = NULL;
+    bool trace_options = false; // -S or -l given
 
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-s") == 0) {
@@ -33,6 +50,10 @@ bool parse_args(int argc, char **argv, Args *out) {
             if (i + 1 >= argc) return false;
             out->filter_file = argv[++i];
 
+        } else if (strcmp(argv[i], "-z") == 0) {
+            if (i + 1 >= argc) return false;
+            out->zone_file = argv[++i];
+
         } else if (strcmp(argv[i], "-p") == 0) {
             if (i + 1 >= argc) return false;
             out->port = atoi(argv[++i]);
@@ -40,6 +61,38 @@ bool parse_args(int argc, char **argv, Args *out) {
                 fprintf(stderr, "Neplatný port: %d\n", out->port);
                 return false;
             }
+        } else if (strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "-R") == 0) {
+            if (i + 1 >= argc) return false;
+            int *limit = argv[i][1] == 'r' ? &out->rate_limit : &out->response_rate_limit;
+            *limit = atoi(argv[++i]);
+            if (*limit < 0 || *limit > 1000000) {
+                fprintf(stderr, "Neplatný limit: %d\n", *limit);
+                return false;
+            }
+        } else if (strcmp(argv[i], "-t") == 0) {
+            if (i + 1 >= argc) return false;
+            out->slow_ms = atoi(argv[++i]);
+            if (out->slow_ms < 0) {
+                fprintf(stderr, "Neplatný práh: %d\n", out->slow_ms);
+                return false;
+            }
+        } else if (strcmp(argv[i], "-S") == 0) {
+            if (i + 1 >= argc) return false;
+            out->trace_sample = atoi(argv[++i]);
+            trace_options = true;
+            if (out->trace_sample <= 0) {
+                fprintf(stderr, "Neplatná vzorkovací perioda: %d\n", out->trace_sample);
+                return false;
+            }
+        } else if (strcmp(argv[i], "-l") == 0) {
+            if (i + 1 >= argc) return false;
+            out->slow_log = argv[++i];
+            trace_options = true;
+
+        } else if (strcmp(argv[i], "-u") == 0) {
+            if (i + 1 >= argc) return false;
+            out->control_path = argv[++i];
+
         } else if (strcmp(argv[i], "-v") == 0) {
             out->verbose = true; 
         } else {
@@ -53,5 +106,11 @@ bool parse_args(int argc, char **argv, Args *out) {
         return false;
     }
 
+    // -S and -l only configure tracing, which is enabled by -t
+    if (trace_options && out->slow_ms < 0) {
+        fprintf(stderr, "Parametry -S a -l vyžadují -t\n");
+        return false;
+    }
+
     return true;
 }
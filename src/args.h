@@ -10,14 +10,29 @@
  * Members:
  *  - server:       Hostname or IP address of the upstream DNS resolver (required).
  *  - filter_file:  Path to a file containing blocked domain names (required).
+ *  - zone_file:    Path to a file with local overrides answered directly (optional).
  *  - verbose:      If true, prints additional diagnostic information.
  *  - port:         Local port on which the proxy listens (default: 53).
+ *  - rate_limit:   Queries per second allowed per client prefix (0 = unlimited).
+ *  - response_rate_limit: Identical responses per second per client prefix
+ *                  (0 = unlimited).
+ *  - slow_ms:      Slow-query log threshold in milliseconds, enables tracing (-1 = off).
+ *  - trace_sample: Trace every n-th query (default: 1).
+ *  - slow_log:     Path of the slow-query log (default: stderr).
+ *  - control_path: Unix socket for listening-socket handoff on upgrade (optional).
  */
 typedef struct {
     const char *server;
     const char *filter_file;
+    const char *zone_file;
     bool verbose;
     int port;
+    int rate_limit;
+    int response_rate_limit;
+    int slow_ms;
+    int trace_sample;
+    const char *slow_log;
+    const char *control_path;
 } Args;
 
 /**
@@ -27,6 +42,14 @@ typedef struct {
  *   -s <server>       Upstream DNS server (required)
  *   -f <filter_file>  File with list of blocked domains (required)
  *   -p <port>         Local listening port (optional, default 53)
+ *   -z <zone_file>    File with local A/AAAA/CNAME overrides (optional)
+ *   -r <qps>          Per-client-prefix query rate limit (optional, default off)
+ *   -R <rps>          Per-client-prefix response rate limit (optional, default off)
+ *   -t <ms>           Trace queries and log those slower than ms (optional)
+ *   -S <n>            Trace only every n-th query (optional, default 1)
+ *   -l <log_file>     Write slow queries to file instead of stderr (optional)
+ *   -u <socket_path>  Take over / hand off the listening socket via a Unix
+ *                     socket for zero-downtime upgrades (optional)
  *   -v                Enable verbose diagnostic output (optional)
  *
  * @param argc  Number of command-line arguments.
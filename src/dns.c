@@ -3,14 +3,38 @@
 *Login: xzavadt00
 ************************************/
 
+#define _POSIX_C_SOURCE 200809L
 #include "dns.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdlib.h>
+#include <strings.h> // for strcasecmp, strncasecmp
 
 #define DNS_HEADER_SIZE 12
 #define DNS_CLASS_IN 1
 
+// Mnemonics of record types known by name
+static const struct {
+    uint16_t type;
+    const char *name;
+} dns_type_names[] = {
+    { DNS_TYPE_A,     "A" },
+    { DNS_TYPE_NS,    "NS" },
+    { DNS_TYPE_CNAME, "CNAME" },
+    { DNS_TYPE_SOA,   "SOA" },
+    { DNS_TYPE_PTR,   "PTR" },
+    { DNS_TYPE_MX,    "MX" },
+    { DNS_TYPE_TXT,   "TXT" },
+    { DNS_TYPE_AAAA,  "AAAA" },
+    { DNS_TYPE_SRV,   "SRV" },
+    { DNS_TYPE_SVCB,  "SVCB" },
+    { DNS_TYPE_HTTPS, "HTTPS" },
+    { DNS_TYPE_ANY,   "ANY" },
+};
+
+#define DNS_TYPE_NAMES_COUNT (sizeof(dns_type_names) / sizeof(dns_type_names[0]))
+
 bool dns_parse_question(const uint8_t *buf, int len, DnsQuestion *out) {
     if (len < DNS_HEADER_SIZE + 5) // header + at least 1 label + qtype/qclass
         return false;
@@ -45,35 +69,38 @@ bool dns_parse_question(const uint8_t *buf, int len, DnsQuestion *out) {
     return true;
 }
 
-bool dns_build_error_response(const uint8_t *request, int request_len,
-                              uint8_t *response, int *response_len,
-                              uint8_t rcode)
-{
-    if (request_len < 12) return false;
-
-    // Copy header
-    memcpy(response, request, DNS_HEADER_SIZE);
-
-    // QR = 1, keep OPCODE and RD, set RCODE
-    response[2] |= 0x80;               // QR=1
-    response[3] = (response[3] & 0xF0) | (rcode & 0x0F);
+// Length of the header and question section(s) of a request (EDNS OPT and
+// other trailing records excluded), or -1 if the request is malformed
+static int dns_question_end(const uint8_t *request, int request_len) {
+    if (request_len < DNS_HEADER_SIZE) return -1;
 
     // QDCOUNT
     int qdcount = (request[4] << 8) | request[5];
 
-    // Copy question section(s)
     int pos = DNS_HEADER_SIZE;
     for (int q = 0; q < qdcount; q++) {
         while (pos < request_len) {
             uint8_t len = request[pos++];
             if (len == 0) break;
             pos += len;
-            if (pos >= request_len) return false;
+            if (pos >= request_len) return -1;
         }
         pos += 4; // QTYPE + QCLASS
-        if (pos > request_len) return false;
+        if (pos > request_len) return -1;
     }
+    return pos;
+}
+
+// Copy header and question section(s) of a request into a response.
+// Returns the length copied, or -1 if the request is malformed.
+static int dns_copy_question(const uint8_t *request, int request_len,
+                             uint8_t *response)
+{
+    int pos = dns_question_end(request, request_len);
+    if (pos < 0) return -1;
 
+    // Copy header and question section(s)
+    memcpy(response, request, DNS_HEADER_SIZE);
     int qsize = pos - DNS_HEADER_SIZE;
     if (qsize > 0)
         memcpy(response + DNS_HEADER_SIZE, request + DNS_HEADER_SIZE, qsize);
@@ -83,7 +110,171 @@ bool dns_build_error_response(const uint8_t *request, int request_len,
     response[8] = response[9] = 0;
     response[10] = response[11] = 0;
 
-    *response_len = DNS_HEADER_SIZE + qsize;
+    return pos;
+}
+
+bool dns_build_error_response(const uint8_t *request, int request_len,
+                              uint8_t *response, int *response_len,
+                              uint8_t rcode)
+{
+    int len = dns_copy_question(request, request_len, response);
+    if (len < 0) return false;
+
+    // QR = 1, keep OPCODE and RD, set RCODE
+    response[2] |= 0x80;               // QR=1
+    response[3] = (response[3] & 0xF0) | (rcode & 0x0F);
+
+    *response_len = len;
 
     return true;
 }
+
+bool dns_build_answer_response(const uint8_t *request, int request_len,
+                               uint8_t *response, int *response_len,
+                               int response_size,
+                               const DnsRecord *answers, int answer_count)
+{
+    // Only header and question are copied, trailing records (EDNS OPT) are not
+    int end = dns_question_end(request, request_len);
+    if (end < 0 || end > response_size) return false;
+
+    int pos = dns_copy_question(request, request_len, response);
+
+    // QR = 1, AA = 1, keep OPCODE and RD; RA = 1, RCODE = NOERROR
+    response[2] = (response[2] & 0x79) | 0x84;
+    response[3] = 0x80;
+
+    int ancount = 0;
+    for (int i = 0; i < answer_count; i++) {
+        const DnsRecord *rr = &answers[i];
+        uint8_t owner[256];
+        int owner_len;
+
+        if (rr->name) {
+            owner_len = dns_encode_name(rr->name, owner, sizeof(owner));
+            if (owner_len < 0) return false;
+        } else {
+            // Pointer to the question name right after the header
+            owner[0] = 0xC0;
+            owner[1] = DNS_HEADER_SIZE;
+            owner_len = 2;
+        }
+
+        // Does not fit: send what we have with TC set
+        if (pos + owner_len + 10 + rr->rdlength > response_size) {
+            response[2] |= 0x02;
+            break;
+        }
+
+        memcpy(response + pos, owner, owner_len);
+        pos += owner_len;
+        response[pos++] = rr->type >> 8;
+        response[pos++] = rr->type & 0xFF;
+        response[pos++] = 0;
+        response[pos++] = DNS_CLASS_IN;
+        response[pos++] = (rr->ttl >> 24) & 0xFF;
+        response[pos++] = (rr->ttl >> 16) & 0xFF;
+        response[pos++] = (rr->ttl >> 8) & 0xFF;
+        response[pos++] = rr->ttl & 0xFF;
+        response[pos++] = rr->rdlength >> 8;
+        response[pos++] = rr->rdlength & 0xFF;
+        memcpy(response + pos, rr->rdata, rr->rdlength);
+        pos += rr->rdlength;
+        ancount++;
+    }
+
+    response[6] = ancount >> 8;
+    response[7] = ancount & 0xFF;
+
+    *response_len = pos;
+
+    return true;
+}
+
+// Position after a (possibly compressed) name at pos, or -1 if it is truncated
+static int dns_skip_name(const uint8_t *buf, int len, int pos) {
+    while (pos < len) {
+        uint8_t label = buf[pos];
+        if (label == 0) return pos + 1;
+        if ((label & 0xC0) == 0xC0) return pos + 2 <= len ? pos + 2 : -1;
+        if (label & 0xC0) return -1;
+        pos += 1 + label;
+    }
+    return -1;
+}
+
+int dns_udp_payload_size(const uint8_t *request, int request_len, int max_size) {
+    int pos = dns_question_end(request, request_len);
+    if (pos < 0) return DNS_UDP_PLAIN_SIZE;
+
+    int ancount = (request[6] << 8) | request[7];
+    int nscount = (request[8] << 8) | request[9];
+    int arcount = (request[10] << 8) | request[11];
+
+    // Walk the records after the question, the OPT record is in the additional section
+    for (int i = 0; i < ancount + nscount + arcount; i++) {
+        pos = dns_skip_name(request, request_len, pos);
+        if (pos < 0 || pos + 10 > request_len) break;
+
+        uint16_t type  = (request[pos] << 8) | request[pos + 1];
+        uint16_t size  = (request[pos + 2] << 8) | request[pos + 3];
+        uint16_t rdlen = (request[pos + 8] << 8) | request[pos + 9];
+
+        if (i >= ancount + nscount && type == DNS_TYPE_OPT) {
+            if (size < DNS_UDP_PLAIN_SIZE) return DNS_UDP_PLAIN_SIZE;
+            return size < max_size ? size : max_size;
+        }
+        pos += 10 + rdlen;
+    }
+    return DNS_UDP_PLAIN_SIZE;
+}
+
+int dns_encode_name(const char *name, uint8_t *out, int out_size) {
+    int pos = 0;
+    const char *label = name;
+
+    while (*label) {
+        const char *dot = strchr(label, '.');
+        int len = dot ? (int)(dot - label) : (int)strlen(label);
+
+        if (len == 0 || len > 63) return -1; // empty or oversized label
+        if (pos + 1 + len + 1 > out_size) return -1;
+
+        out[pos++] = (uint8_t)len;
+        memcpy(out + pos, label, len);
+        pos += len;
+
+        if (!dot) break;
+        label = dot + 1;
+    }
+
+    if (pos + 1 > out_size) return -1;
+    out[pos++] = 0;
+
+    return pos;
+}
+
+uint16_t dns_type_from_string(const char *name) {
+    for (size_t i = 0; i < DNS_TYPE_NAMES_COUNT; i++) {
+        if (strcasecmp(name, dns_type_names[i].name) == 0)
+            return dns_type_names[i].type;
+    }
+
+    // Generic form: TYPE<number> (RFC 3597)
+    if (strncasecmp(name, "TYPE", 4) == 0 && name[4] != '\0') {
+        char *end;
+        long value = strtol(name + 4, &end, 10);
+        if (*end == '\0' && value > 0 && value <= 65535)
+            return (uint16_t)value;
+    }
+
+    return 0;
+}
+
+const char *dns_type_to_string(uint16_t type) {
+    for (size_t i = 0; i < DNS_TYPE_NAMES_COUNT; i++) {
+        if (dns_type_names[i].type == type)
+            return dns_type_names[i].name;
+    }
+    return "UNKNOWN";
+}
@@ -9,11 +9,39 @@
  */
 #define DNS_TYPE_A 1
 
+/**
+ * @brief Other common DNS record types (RFC 1035, RFC 3596, RFC 9460).
+ *
+ * The proxy forwards every query type; these values are used for
+ * per-type filter rules and diagnostic output.
+ */
+#define DNS_TYPE_NS     2
+#define DNS_TYPE_CNAME  5
+#define DNS_TYPE_SOA    6
+#define DNS_TYPE_PTR    12
+#define DNS_TYPE_MX     15
+#define DNS_TYPE_TXT    16
+#define DNS_TYPE_AAAA   28
+#define DNS_TYPE_SRV    33
+#define DNS_TYPE_SVCB   64
+#define DNS_TYPE_HTTPS  65
+#define DNS_TYPE_ANY    255
+
+/**
+ * @brief EDNS(0) pseudo-record type (RFC 6891), its CLASS is the payload size.
+ */
+#define DNS_TYPE_OPT 41
+
 /**
  * @brief DNS class: Internet (IN).
  */
 #define DNS_CLASS_IN 1
 
+/**
+ * @brief Maximum size of a UDP response to a client without EDNS(0).
+ */
+#define DNS_UDP_PLAIN_SIZE 512
+
 /**
  * @struct DnsQuestion
  * @brief Represents a parsed DNS question section.
@@ -28,10 +56,30 @@
  */
 typedef struct {
     char qname[256];     /**< Extracted domain name as a C string */
-    uint16_t qtype;      /**< DNS query type (usually DNS_TYPE_A = 1) */
+    uint16_t qtype;      /**< DNS query type (e.g., DNS_TYPE_A, DNS_TYPE_AAAA) */
     uint16_t qclass;     /**< DNS class (usually DNS_CLASS_IN = 1) */
 } DnsQuestion;
 
+/**
+ * @struct DnsRecord
+ * @brief A resource record to be placed in the answer section of a response.
+ *
+ * Members:
+ *  - name:     Owner name as a C string, or NULL for the question name
+ *              (encoded as a compression pointer to the question).
+ *  - type:     Record type (e.g., DNS_TYPE_A).
+ *  - ttl:      Time to live in seconds.
+ *  - rdlength: Length of @ref rdata in bytes.
+ *  - rdata:    Record data in wire format.
+ */
+typedef struct {
+    const char *name;      /**< Owner name, NULL = same as question */
+    uint16_t type;         /**< Record type */
+    uint32_t ttl;          /**< Time to live in seconds */
+    uint16_t rdlength;     /**< Length of rdata */
+    const uint8_t *rdata;  /**< Wire-format record data */
+} DnsRecord;
+
 /**
  * @brief Parse the question section of a DNS query packet.
  *
@@ -55,7 +103,8 @@ bool dns_parse_question(const uint8_t *packet, int packet_len, DnsQuestion *out)
  *
  * This function preserves the Transaction ID (TXID) and question section,
  * converts the query into a response (QR=1), and sets the given RCODE.
- * It produces a minimal valid error message such as NXDOMAIN or NOTIMP.
+ * It produces a minimal valid error message such as NXDOMAIN or NOTIMP,
+ * or a non-authoritative NODATA response with RCODE 0 (NOERROR).
  *
  * Common DNS error RCODE values:
  *  - 1 = Format error
@@ -76,4 +125,78 @@ bool dns_build_error_response(const uint8_t *request, int request_len,
                               uint8_t *response, int *response_len,
                               uint8_t rcode);
 
+/**
+ * @brief Construct an authoritative DNS response with the given answers.
+ *
+ * The TXID, RD flag and question section of the request are preserved,
+ * QR and AA are set and RCODE is NOERROR. Passing zero answers produces
+ * a NODATA response. Records that do not fit into @p response_size bytes
+ * are left out and the TC flag is set instead; size the response with
+ * @ref dns_udp_payload_size.
+ *
+ * @param request        Original DNS request.
+ * @param request_len    Length of the request in bytes.
+ * @param response       Buffer to write the generated DNS response.
+ * @param response_len   Output: length of the generated response.
+ * @param response_size  Maximum response size in bytes (at most the buffer capacity).
+ * @param answers        Records for the answer section.
+ * @param answer_count   Number of records in @p answers.
+ *
+ * @return true on success, false if the request is malformed or its header
+ *         and question do not fit into @p response_size bytes.
+ */
+bool dns_build_answer_response(const uint8_t *request, int request_len,
+                               uint8_t *response, int *response_len,
+                               int response_size,
+                               const DnsRecord *answers, int answer_count);
+
+/**
+ * @brief Maximum UDP response size accepted by the client.
+ *
+ * Reads the requestor's payload size from the EDNS(0) OPT record in the
+ * additional section (RFC 6891). Without EDNS, or if the advertised size
+ * is below 512, @ref DNS_UDP_PLAIN_SIZE is returned.
+ *
+ * @param request      Original DNS request.
+ * @param request_len  Length of the request in bytes.
+ * @param max_size     Upper bound of the result (capacity of the response buffer).
+ *
+ * @return Response size limit in bytes.
+ */
+int dns_udp_payload_size(const uint8_t *request, int request_len, int max_size);
+
+/**
+ * @brief Encode a domain name into uncompressed DNS wire format.
+ *
+ * A trailing dot is optional. The root name is encoded as a single zero byte.
+ *
+ * @param name      Domain name (null-terminated).
+ * @param out       Output buffer.
+ * @param out_size  Capacity of the output buffer.
+ *
+ * @return Number of bytes written, or -1 if the name is invalid or does not fit.
+ */
+int dns_encode_name(const char *name, uint8_t *out, int out_size);
+
+/**
+ * @brief Convert a record type mnemonic to its numeric value.
+ *
+ * Accepts the names of the DNS_TYPE_* constants (case-insensitive, e.g.
+ * "AAAA", "https") as well as the generic RFC 3597 form "TYPE<number>".
+ *
+ * @param name  Type mnemonic (null-terminated).
+ *
+ * @return Numeric record type, or 0 if the name is not recognized.
+ */
+uint16_t dns_type_from_string(const char *name);
+
+/**
+ * @brief Convert a numeric record type to its mnemonic.
+ *
+ * @param type  Numeric record type.
+ *
+ * @return Static string such as "AAAA", or "UNKNOWN" for unlisted types.
+ */
+const char *dns_type_to_string(uint16_t type);
+
 #endif // DNS_H
@@ -10,6 +10,7 @@
 #include <ctype.h>
 #include <strings.h> // for strcasecmp
 #include "filter.h"
+#include "dns.h"
 
 #define MAX_LINE_LEN 256
 
@@ -34,14 +35,33 @@ bool filter_load(const char *filename, FilterList *out) {
         // skip empty lines or comments
         if (line[0] == '\0' || line[0] == '#') continue;
 
-        char *domain = strdup(line);
+        // split "domain [type]"
+        char *save;
+        char *name = strtok_r(line, " \t", &save);
+        if (!name) continue;
+
+        uint16_t qtype = 0;
+        char *type = strtok_r(NULL, " \t", &save);
+        if (type) {
+            qtype = dns_type_from_string(type);
+            if (qtype == 0 || strtok_r(NULL, " \t", &save)) {
+                fprintf(stderr, "Neplatné pravidlo ve filter file: %s %s\n", name, type);
+                fclose(f);
+                filter_free(out);
+                return 0;
+            }
+        }
+
+        char *domain = strdup(name);
         if (!domain) {
             fclose(f);
+            filter_free(out);
             return 0;
         }
 
         strtolower_inplace(domain);
         out->domains[out->count] = domain;
+        out->qtypes[out->count] = qtype;
         out->count++;
     }
 
@@ -57,8 +77,11 @@ void filter_free(FilterList *list) {
     list->count = 0;
 }
 
-// Check if domain is blocked
-bool filter_is_blocked(const FilterList *list, const char *domain) {
+// Check if domain is blocked for the given query type
+bool filter_is_blocked(const FilterList *list, const char *domain, uint16_t qtype,
+                       int *rule) {
+    int match = -1;
+
     char tmp[strlen(domain) + 1];
     strcpy(tmp, domain);
 
@@ -69,10 +92,15 @@ bool filter_is_blocked(const FilterList *list, const char *domain) {
     strtolower_inplace(tmp);
 
     for (int i = 0; i < list->count; i++) {
+        // Rule restricted to another query type
+        if (list->qtypes[i] != 0 && list->qtypes[i] != qtype) continue;
+
         const char *f = list->domains[i];
         size_t flen = strlen(f);
         if (flen == 0) continue;
 
+        bool hit = 0;
+
         // Wildcard at the start (*.example.com)
         if (f[0] == '*') {
             const char *suffix = f + 1; // skip '*'
@@ -82,7 +110,7 @@ bool filter_is_blocked(const FilterList *list, const char *domain) {
             // Match if domain ends with the suffix
             if (dlen >= slen &&
                 strcasecmp(tmp + dlen - slen, suffix) == 0) {
-                return 1;
+                hit = 1;
             }
         } else {
             // Exact match or subdomain match
@@ -95,7 +123,7 @@ bool filter_is_blocked(const FilterList *list, const char *domain) {
             
             // Exact match
             if (strcasecmp(tmp, f) == 0) {
-                return 1;
+                hit = 1;
             }
             
             // Subdomain match
@@ -104,11 +132,18 @@ bool filter_is_blocked(const FilterList *list, const char *domain) {
                 // Check if there's a dot before the matching part
                 if (tmp[dlen - flen - 1] == '.' &&
                     strcasecmp(tmp + dlen - flen, f) == 0) {
-                    return 1;
+                    hit = 1;
                 }
             }
         }
+
+        if (!hit) continue;
+
+        // Rules for all types take precedence over type-restricted ones
+        if (match < 0 || list->qtypes[i] == 0) match = i;
+        if (list->qtypes[i] == 0) break;
     }
 
-    return 0;
+    if (rule) *rule = match;
+    return match >= 0;
 }
\ No newline at end of file
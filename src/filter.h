@@ -2,6 +2,7 @@
 #define FILTER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * @brief Maximum number of domain patterns that can be loaded from the filter file.
@@ -18,16 +19,22 @@
  *  - exact matches (e.g., "example.com")
  *  - subdomain patterns using leading wildcard notation (e.g., "*.example.com")
  *
+ * A rule may be restricted to a single query type; such rules block only
+ * queries of that type (answered with NODATA instead of NXDOMAIN) and let
+ * every other type through to the upstream.
+ *
  * Memory ownership:
  *  Each string stored in the @ref domains array is dynamically allocated and must be
  *  released with @ref filter_free after use.
  *
  * Members:
  *  - domains: Array of pointers to domain rule strings.
+ *  - qtypes:  Query type each rule applies to (0 = all types).
  *  - count:   Number of valid entries in the list.
  */
 typedef struct {
     char *domains[MAX_FILTER_DOMAINS]; /**< Array of dynamically allocated blocked domains */
+    uint16_t qtypes[MAX_FILTER_DOMAINS]; /**< Query type per rule, 0 matches any type */
     int  count;                        /**< Count of valid stored entries */
 } FilterList;
 
@@ -42,6 +49,8 @@ typedef struct {
  *   `blocked.org`          – exact domain match
  *   `.sub.example.com`     – blocks subdomains only
  *   `*.example.net`        – wildcard blocking of all subdomains
+ *   `example.org AAAA`     – blocks only AAAA queries (any type mnemonic
+ *                            accepted by @ref dns_type_from_string)
  *
  * @param filename  Path to the filter file.
  * @param out       Pointer to FilterList to be populated.
@@ -60,7 +69,7 @@ bool filter_load(const char *filename, FilterList *out);
 void filter_free(FilterList *list);
 
 /**
- * @brief Determine whether a domain name is blocked.
+ * @brief Determine whether a query for a domain name is blocked.
  *
  * Performs a rule-based lookup against all loaded filter patterns.
  * Matching behavior (typical implementation):
@@ -71,12 +80,19 @@ void filter_free(FilterList *list);
  *   Rule: "example.com"      blocks "example.com" only
  *   Rule: "*.example.com"    blocks "test.example.com", "a.b.example.com", etc.
  *   Rule: ".example.com"     same behavior as "*.example.com"
+ *   Rule: "example.com AAAA" blocks only AAAA queries for the domain
+ *
+ * If both a rule for all types and a type-restricted rule match, the rule
+ * for all types is reported.
  *
  * @param list    Pointer to initialized FilterList.
  * @param domain  Domain name to check (null-terminated).
+ * @param qtype   Query type of the request.
+ * @param rule    Output: index of the matching rule, -1 if none (may be NULL).
  *
- * @return true if the domain is blocked, false otherwise.
+ * @return true if the query is blocked, false otherwise.
  */
-bool filter_is_blocked(const FilterList *list, const char *domain);
+bool filter_is_blocked(const FilterList *list, const char *domain, uint16_t qtype,
+                       int *rule);
 
 #endif // FILTER_H
@@ -19,7 +19,7 @@
 bool resolver_forward_query(const char *server,
                             const uint8_t *query, int query_len,
                             uint8_t *response, int *response_len,
-                            int timeout_sec)
+                            int timeout_sec, QueryTrace *trace)
 {
     struct addrinfo hints, *result, *rp;
     int sock = -1;
@@ -62,6 +62,7 @@ bool resolver_forward_query(const char *server,
             sock = -1;
             continue;
         }
+        trace_mark(trace, TRACE_UPSTREAM_SENT);
 
         // Receive response
         struct sockaddr_in from_addr;
@@ -80,6 +81,7 @@ bool resolver_forward_query(const char *server,
         }
 
         // Success
+        trace_mark(trace, TRACE_UPSTREAM_RECEIVED);
         *response_len = recvd;
 
         // Overwrite TXID to match our query (proxy behavior)
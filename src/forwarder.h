@@ -3,8 +3,9 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "trace.h"
 
-#define DNS_MAX_PACKET_SIZE 512  // Standard UDP DNS packet limit
+#define DNS_MAX_PACKET_SIZE 4096  // EDNS(0) UDP payload limit (plain DNS uses 512)
 
 /**
  * @brief Forwards a DNS query to an upstream resolver and returns its response.
@@ -20,12 +21,13 @@
  * @param response      Output buffer for DNS response
  * @param response_len  Receives length of response data
  * @param timeout_sec   Maximum wait time for a DNS answer
+ * @param trace         Query trace for upstream send/receive stages (may be NULL)
  *
  * @return true on success, false on error or timeout.
  */
 bool resolver_forward_query(const char *server,
                             const uint8_t *query, int query_len,
                             uint8_t *response, int *response_len,
-                            int timeout_sec);
+                            int timeout_sec, QueryTrace *trace);
 
 #endif
@@ -0,0 +1,149 @@
+/************************************
+*Jméno autora: Tomáš Zavadil
+*Login: xzavadt00
+************************************/
+
+#define _GNU_SOURCE // for struct ucred / SO_PEERCRED
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "handoff.h"
+
+// Fill a Unix socket address, fails if the path does not fit
+static bool make_address(const char *path, struct sockaddr_un *addr) {
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, "Cesta k řídicímu socketu je příliš dlouhá: %s\n", path);
+        return false;
+    }
+    strcpy(addr->sun_path, path);
+    return true;
+}
+
+int handoff_receive(const char *path, int *conn) {
+    *conn = -1;
+    struct sockaddr_un addr;
+    if (!make_address(path, &addr)) return -1;
+
+    int c = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (c < 0) return -1;
+
+    // No instance is running (or it does not accept handoffs)
+    if (connect(c, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(c);
+        return -1;
+    }
+
+    char byte;
+    struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = control.buf, .msg_controllen = sizeof(control.buf)
+    };
+
+    int fd = -1;
+    if (recvmsg(c, &msg, 0) == 1) {
+        struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+        if (cm && cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS &&
+            cm->cmsg_len == CMSG_LEN(sizeof(int))) {
+            memcpy(&fd, CMSG_DATA(cm), sizeof(int));
+        }
+    }
+
+    // Keep the connection open for the ack, the predecessor serves until then
+    if (fd < 0) {
+        close(c);
+        return -1;
+    }
+    *conn = c;
+    return fd;
+}
+
+void handoff_ack(int conn) {
+    char byte = 0;
+    send(conn, &byte, 1, MSG_NOSIGNAL); // predecessor may be gone already
+    close(conn);
+}
+
+int handoff_listen(const char *path) {
+    struct sockaddr_un addr;
+    if (!make_address(path, &addr)) return -1;
+
+    // Replace only a stale socket, never a regular file or anything else
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "Cesta k řídicímu socketu není socket: %s\n", path);
+            errno = EEXIST;
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int control = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (control < 0) return -1;
+
+    // Only the owner may connect (mode 0600), set atomically by bind
+    mode_t old_mask = umask(0177);
+    int bound = bind(control, (struct sockaddr*)&addr, sizeof(addr));
+    umask(old_mask);
+    if (bound < 0 || listen(control, 1) < 0) {
+        close(control);
+        return -1;
+    }
+
+    return control;
+}
+
+int handoff_send(int control, int sock) {
+    int conn = accept(control, NULL, NULL);
+    if (conn < 0) return -1;
+
+    // Never hand the socket to a process of another user
+    struct ucred cred;
+    socklen_t cred_len = sizeof(cred);
+    if (getsockopt(conn, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) < 0 ||
+        cred.uid != geteuid()) {
+        close(conn);
+        return -1;
+    }
+
+    char byte = 0;
+    struct iovec iov = { .iov_base = &byte, .iov_len = 1 };
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control_msg;
+    struct msghdr msg = {
+        .msg_iov = &iov, .msg_iovlen = 1,
+        .msg_control = control_msg.buf, .msg_controllen = sizeof(control_msg.buf)
+    };
+
+    struct cmsghdr *c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(c), &sock, sizeof(int));
+
+    if (sendmsg(conn, &msg, MSG_NOSIGNAL) != 1) { // successor may be gone
+        close(conn);
+        return -1;
+    }
+    return conn;
+}
+
+bool handoff_wait_ack(int conn) {
+    char byte;
+    bool acked = recv(conn, &byte, 1, 0) == 1;
+    close(conn);
+    return acked;
+}
@@ -0,0 +1,72 @@
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include <stdbool.h>
+
+/**
+ * @brief Take over the listening socket of a running instance.
+ *
+ * Connects to the control socket at @p path and receives the listening
+ * UDP socket via SCM_RIGHTS. The running instance keeps serving from the
+ * shared socket until the new one confirms it is ready with @ref handoff_ack;
+ * then it exits. Datagrams that are still queued in the kernel are served
+ * by the new owner, so none are lost.
+ *
+ * @param path  Path of the Unix control socket.
+ * @param conn  Output: connection to the running instance, to be passed to
+ *              @ref handoff_ack (-1 if no socket was received).
+ *
+ * @return Received socket descriptor, or -1 if no instance is running
+ *         at @p path or the handoff failed.
+ */
+int handoff_receive(const char *path, int *conn);
+
+/**
+ * @brief Tell the previous instance that this one is ready to serve.
+ *
+ * Call only after everything that can fail during startup has succeeded.
+ * If the new instance exits without the ack instead, the previous instance
+ * keeps serving.
+ *
+ * @param conn  Connection from @ref handoff_receive, closed by this call.
+ */
+void handoff_ack(int conn);
+
+/**
+ * @brief Create the control socket on which successors request a handoff.
+ *
+ * A stale socket file left at @p path (e.g. by the predecessor) is removed.
+ * If anything else than a socket exists at @p path, it is left untouched
+ * and the call fails.
+ * The socket is created with mode 0600, so only the owner can connect.
+ *
+ * @param path  Path of the Unix control socket.
+ *
+ * @return Listening control socket descriptor, or -1 on error.
+ */
+int handoff_listen(const char *path);
+
+/**
+ * @brief Accept a successor on the control socket and pass it a socket.
+ *
+ * Successors running under a different user (SO_PEERCRED) are refused.
+ *
+ * @param control  Control socket from @ref handoff_listen.
+ * @param sock     Listening UDP socket to hand off.
+ *
+ * @return Connection to the successor for @ref handoff_wait_ack, or -1 if
+ *         the socket was not passed.
+ */
+int handoff_send(int control, int sock);
+
+/**
+ * @brief Read the successor's ack once its connection becomes readable.
+ *
+ * @param conn  Connection from @ref handoff_send, closed by this call.
+ *
+ * @return true if the successor is ready to serve, false if it exited
+ *         without acknowledging (the caller keeps serving).
+ */
+bool handoff_wait_ack(int conn);
+
+#endif // HANDOFF_H
@@ -8,15 +8,48 @@
 #include <string.h>
 #include <unistd.h>
 #include <arpa/inet.h>
+#include <errno.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include "args.h"
 #include "filter.h"
 #include "dns.h"
 #include "forwarder.h"
+#include "zone.h"
+#include "ratelimit.h"
+#include "trace.h"
+#include "handoff.h"
 
-#define BUF_SIZE 512
+#define BUF_SIZE DNS_MAX_PACKET_SIZE
 #define DEFAULT_TIMEOUT 5  // seconds
 
+// Rate limiter tables are large, keep them out of the stack
+static RateLimiter query_limiter;
+static RateLimiter response_limiter;
+
+// Response rate limiting: returns true if the response may be sent. Otherwise
+// the response is dropped, or a minimal REFUSED reply is sent instead (slip).
+// BIND slips with TC=1, but this proxy has no TCP listener for the retry;
+// REFUSED is no larger than the query and makes the client try another server.
+static bool response_allowed(uint64_t key, uint64_t now_ms, int sock,
+                             const uint8_t *query, int query_len,
+                             const struct sockaddr_storage *client_addr,
+                             socklen_t client_len)
+{
+    if (!response_limiter.rate) return true;
+
+    RateVerdict verdict = ratelimit_check(&response_limiter, key, now_ms);
+    if (verdict == RATELIMIT_SLIP) {
+        uint8_t slip[BUF_SIZE];
+        int slip_len;
+        if (dns_build_error_response(query, query_len, slip, &slip_len, 5)) { // REFUSED
+            sendto(sock, slip, slip_len, 0,
+                   (const struct sockaddr*)client_addr, client_len);
+        }
+    }
+    return verdict == RATELIMIT_PASS;
+}
+
 int main(int argc, char **argv) {
     Args args;
     if (!parse_args(argc, argv, &args)) {
@@ -31,48 +64,172 @@ int main(int argc, char **argv) {
         return 2;
     }
 
-    // Open UDP socket with IPv6 (dual-stack - supports both IPv4 and IPv6)
-    int sock = socket(AF_INET6, SOCK_DGRAM, 0);
-    if (sock < 0) {
-        perror("socket");
+    // Load local overrides
+    ZoneTable zone = {0};
+    if (args.zone_file && !zone_load(args.zone_file, &zone)) {
+        fprintf(stderr, "Chyba: nelze načíst zone file.\n");
         filter_free(&filters);
-        return 3;
+        return 2;
     }
 
-    // Enable dual-stack mode (accept both IPv4 and IPv6)
-    int ipv6only = 0;
-    if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &ipv6only, sizeof(ipv6only)) < 0) {
-        perror("setsockopt IPV6_V6ONLY");
-        close(sock);
-        filter_free(&filters);
-        return 3;
+    // Take over the listening socket of a running instance (graceful upgrade)
+    // Until handoff_ack, any failure below just exits and the predecessor keeps serving
+    int sock = -1;
+    int handoff_conn = -1;
+    if (args.control_path) {
+        sock = handoff_receive(args.control_path, &handoff_conn);
+
+        // A different port means a fresh bind, the predecessor releases the old one
+        struct sockaddr_in6 bound;
+        socklen_t bound_len = sizeof(bound);
+        if (sock >= 0 &&
+            (getsockname(sock, (struct sockaddr*)&bound, &bound_len) < 0 ||
+             bound.sin6_family != AF_INET6 || ntohs(bound.sin6_port) != args.port)) {
+            close(sock);
+            sock = -1;
+        }
+        if (sock >= 0 && args.verbose) printf("Listening socket taken over from running instance\n");
     }
 
-    struct sockaddr_in6 local_addr;
-    memset(&local_addr, 0, sizeof(local_addr));
-    local_addr.sin6_family = AF_INET6;
-    local_addr.sin6_port = htons(args.port);
-    local_addr.sin6_addr = in6addr_any;  // Listen on all interfaces (IPv4 and IPv6)
+    if (sock < 0) {
+        // Open UDP socket with IPv6 (dual-stack - supports both IPv4 and IPv6)
+        sock = socket(AF_INET6, SOCK_DGRAM, 0);
+        if (sock < 0) {
+            perror("socket");
+            zone_free(&zone);
+            filter_free(&filters);
+            return 3;
+        }
 
-    if (bind(sock, (struct sockaddr*)&local_addr, sizeof(local_addr)) < 0) {
-        perror("bind");
+        // Enable dual-stack mode (accept both IPv4 and IPv6)
+        int ipv6only = 0;
+        if (setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &ipv6only, sizeof(ipv6only)) < 0) {
+            perror("setsockopt IPV6_V6ONLY");
+            close(sock);
+            zone_free(&zone);
+            filter_free(&filters);
+            return 3;
+        }
+
+        struct sockaddr_in6 local_addr;
+        memset(&local_addr, 0, sizeof(local_addr));
+        local_addr.sin6_family = AF_INET6;
+        local_addr.sin6_port = htons(args.port);
+        local_addr.sin6_addr = in6addr_any;  // Listen on all interfaces (IPv4 and IPv6)
+
+        if (bind(sock, (struct sockaddr*)&local_addr, sizeof(local_addr)) < 0) {
+            perror("bind");
+            close(sock);
+            zone_free(&zone);
+            filter_free(&filters);
+            return 4;
+        }
+    }
+
+    // Per-query stage tracing and slow-query log
+    Tracer tracer;
+    if (!tracer_init(&tracer, sock, args.slow_ms, args.trace_sample, args.slow_log)) {
+        perror("slow query log");
         close(sock);
+        zone_free(&zone);
         filter_free(&filters);
-        return 4;
+        return 2;
+    }
+
+    // Control socket for handing the listening socket to a successor
+    int control_sock = -1;
+    if (args.control_path) {
+        control_sock = handoff_listen(args.control_path);
+        if (control_sock < 0) {
+            perror("control socket");
+            tracer_close(&tracer);
+            close(sock);
+            zone_free(&zone);
+            filter_free(&filters);
+            return 4;
+        }
     }
 
+    // Ready to serve, the predecessor can stop now
+    if (handoff_conn >= 0) handoff_ack(handoff_conn);
+
     if(args.verbose) printf("DNS proxy listening on port %d (IPv4 and IPv6)\n", args.port);
 
+    // Queries over the limit are dropped, limited responses slip as REFUSED
+    ratelimit_init(&query_limiter, args.rate_limit, args.rate_limit, 0);
+    ratelimit_init(&response_limiter, args.response_rate_limit,
+                   args.response_rate_limit, RATELIMIT_DEFAULT_SLIP);
+
     uint8_t buf[BUF_SIZE];
+    int successor = -1;  // Successor holding the socket, not yet acknowledged
 
     while (1) {
+        // Wait for a query, a successor asking for the listening socket or its ack
+        if (args.control_path) {
+            struct pollfd fds[2] = {
+                { .fd = sock, .events = POLLIN },
+                { .fd = successor >= 0 ? successor : control_sock, .events = POLLIN }
+            };
+            if (poll(fds, 2, -1) < 0) {
+                if (errno != EINTR) perror("poll");
+                continue;
+            }
+
+            if (fds[1].revents && successor < 0) {
+                successor = handoff_send(control_sock, sock);
+            } else if (fds[1].revents) {
+                // Queries are handled one at a time, so nothing is in flight here;
+                // datagrams still queued on the socket are served by the successor
+                if (handoff_wait_ack(successor)) {
+                    if (args.verbose) printf("Listening socket handed off, exiting\n");
+                    break;
+                }
+
+                // The successor failed to start, it may have replaced the control socket
+                successor = -1;
+                if (control_sock >= 0) close(control_sock);
+                control_sock = handoff_listen(args.control_path);
+                if (control_sock < 0) perror("control socket");
+            }
+            if (!(fds[0].revents & POLLIN)) continue;
+        }
+
         struct sockaddr_storage client_addr;  // Can hold both IPv4 and IPv6
-        socklen_t client_len = sizeof(client_addr);
 
-        ssize_t r = recvfrom(sock, buf, sizeof(buf), 0,
-                             (struct sockaddr*)&client_addr, &client_len);
+        // recvmsg instead of recvfrom to get the kernel receive timestamp
+        union {
+            char buf[TRACE_CONTROL_SIZE];
+            struct cmsghdr align;
+        } control;
+        struct iovec iov = { .iov_base = buf, .iov_len = sizeof(buf) };
+        struct msghdr msg = {
+            .msg_name = &client_addr, .msg_namelen = sizeof(client_addr),
+            .msg_iov = &iov, .msg_iovlen = 1,
+            // Kernel timestamps are only requested (and parsed) when tracing
+            .msg_control = tracer.enabled ? control.buf : NULL,
+            .msg_controllen = tracer.enabled ? sizeof(control.buf) : 0
+        };
+
+        // The socket may be shared with a successor taking over, never block after poll
+        ssize_t r = recvmsg(sock, &msg, args.control_path ? MSG_DONTWAIT : 0);
         if (r < 0) {
-            perror("recvfrom");
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("recvmsg");
+            continue;
+        }
+        socklen_t client_len = msg.msg_namelen;
+
+        QueryTrace trace;
+        trace_begin(&tracer, &trace, &msg);
+
+        // Per-client rate limit, checked before any parsing or upstream work
+        uint64_t now_ms = 0;
+        uint64_t client_key = 0;
+        if (query_limiter.rate || response_limiter.rate) {
+            now_ms = ratelimit_now_ms();
+            client_key = ratelimit_client_key(&client_addr);
+        }
+        if (ratelimit_check(&query_limiter, client_key, now_ms) != RATELIMIT_PASS) {
+            if(args.verbose) fprintf(stderr, "Query rate limit exceeded, dropped\n");
             continue;
         }
 
@@ -101,36 +258,70 @@ int main(int argc, char **argv) {
             if(args.verbose) fprintf(stderr, "Malformed DNS query received\n");
             continue;
         }
+        trace_mark(&trace, TRACE_PARSED);
 
         uint8_t response[BUF_SIZE];
         int response_len;
 
-        // Only handle type A queries
-        if (q.qtype != DNS_TYPE_A) {
-            if(args.verbose) fprintf(stderr, "Non-A query received: %s\n", q.qname);
-            dns_build_error_response(buf, r, response, &response_len, 4); // NOTIMP
+        if (args.verbose) {
+            fprintf(stderr, "Query: %s %s\n", q.qname, dns_type_to_string(q.qtype));
+        }
+
+        // Decide how the query is answered: local override, filter or upstream
+        int rule = -1;
+        int max_size = dns_udp_payload_size(buf, r, sizeof(response));
+        bool local = zone_answer(&zone, &q, buf, r, response, &response_len, max_size);
+        bool blocked = !local && filter_is_blocked(&filters, q.qname, q.qtype, &rule);
+        trace_mark(&trace, TRACE_FILTERED);
+
+        // Response rate limit, keyed on the response: blocked answers share a
+        // bucket per filter rule, so floods of random blocked names are limited too
+        uint64_t response_key = blocked
+            ? ratelimit_group_key(client_key, RATELIMIT_GROUP_BLOCKED, rule)
+            : ratelimit_response_key(client_key, q.qname, q.qtype);
+        if (!response_allowed(response_key, now_ms, sock, buf, r, &client_addr, client_len)) {
+            if(args.verbose) fprintf(stderr, "Response rate limit exceeded: %s\n", q.qname);
+            continue;
+        }
+
+        // Answer locally overridden names without an upstream trip
+        if (local) {
+            if(args.verbose) fprintf(stderr, "Local answer: %s (%s)\n", q.qname, dns_type_to_string(q.qtype));
             sendto(sock, response, response_len, 0,
                    (struct sockaddr*)&client_addr, client_len);
+            trace_finish(&tracer, &trace, &q, "local");
             continue;
         }
 
-        // Check filter
-        if (filter_is_blocked(&filters, q.qname)) {
-            if(args.verbose) fprintf(stderr, "Blocked domain: %s\n", q.qname);
-            dns_build_error_response(buf, r, response, &response_len, 3); // NXDOMAIN
+        if (blocked) {
+            if(args.verbose) fprintf(stderr, "Blocked domain: %s (%s)\n", q.qname, dns_type_to_string(q.qtype));
+            if (filters.qtypes[rule] != 0) {
+                // Only this type is blocked, the name itself exists: NODATA (RFC 8020),
+                // with the same non-authoritative flags as the NXDOMAIN below
+                dns_build_error_response(buf, r, response, &response_len, 0);
+            } else {
+                dns_build_error_response(buf, r, response, &response_len, 3); // NXDOMAIN
+            }
             sendto(sock, response, response_len, 0,
                    (struct sockaddr*)&client_addr, client_len);
+            trace_finish(&tracer, &trace, &q, "blocked");
             continue;
         }
 
         // Forward query to upstream resolver
         if (!resolver_forward_query(args.server,
                                     buf, r, response, &response_len,
-                                    DEFAULT_TIMEOUT)) {
+                                    DEFAULT_TIMEOUT, &trace)) {
             if(args.verbose) fprintf(stderr, "Failed to query upstream resolver for %s\n", q.qname);
             dns_build_error_response(buf, r, response, &response_len, 2); // SERVFAIL
-            sendto(sock, response, response_len, 0,
-                   (struct sockaddr*)&client_addr, client_len);
+        }
+
+        // Error responses (SERVFAIL, upstream NXDOMAIN, ...) share a bucket per RCODE
+        uint8_t rcode = response[3] & 0x0F;
+        if (rcode != 0 &&
+            !response_allowed(ratelimit_group_key(client_key, RATELIMIT_GROUP_ERROR, rcode),
+                              now_ms, sock, buf, r, &client_addr, client_len)) {
+            if(args.verbose) fprintf(stderr, "Response rate limit exceeded: %s\n", q.qname);
             continue;
         }
 
@@ -145,9 +336,13 @@ int main(int argc, char **argv) {
         if (sent < 0) {
             perror("sendto");
         }
+        trace_finish(&tracer, &trace, &q, "forwarded");
     }
 
+    tracer_close(&tracer);
+    if (control_sock >= 0) close(control_sock);
     close(sock);
+    zone_free(&zone);
     filter_free(&filters);
     return 0;
 }
\ No newline at end of file
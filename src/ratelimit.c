@@ -0,0 +1,141 @@
+/************************************
+*Jméno autora: Tomáš Zavadil
+*Login: xzavadt00
+************************************/
+
+#define _POSIX_C_SOURCE 200809L
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+#include <netinet/in.h>
+#include "ratelimit.h"
+
+#define TOKEN_UNIT 1000  // tokens are stored in thousandths
+
+// Mix a 64-bit key into a well-distributed hash (splitmix64 finalizer)
+static uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Keys must be non-zero, zero marks an unused slot
+static uint64_t nonzero(uint64_t key) {
+    return key ? key : 1;
+}
+
+void ratelimit_init(RateLimiter *rl, uint32_t rate, uint32_t burst, uint32_t slip) {
+    memset(rl->buckets, 0, sizeof(rl->buckets));
+    rl->rate = rate;
+    rl->burst = burst > 0 ? burst : 1;
+    rl->slip = slip;
+}
+
+// Bring bucket tokens up to date
+static void refill(const RateLimiter *rl, RateBucket *b, uint64_t now_ms) {
+    uint64_t capacity = (uint64_t)rl->burst * TOKEN_UNIT;
+    uint64_t elapsed = now_ms - b->last_ms;
+    uint64_t tokens = b->tokens + elapsed * rl->rate; // rate/s == rate*1000/1000ms
+
+    b->tokens = tokens > capacity ? (uint32_t)capacity : (uint32_t)tokens;
+    b->last_ms = now_ms;
+}
+
+// A bucket that has refilled completely carries no state and can be reused
+static bool is_idle(const RateLimiter *rl, const RateBucket *b, uint64_t now_ms) {
+    if (b->key == 0) return true;
+    uint64_t missing = (uint64_t)rl->burst * TOKEN_UNIT - b->tokens;
+    return (now_ms - b->last_ms) * rl->rate >= missing;
+}
+
+RateVerdict ratelimit_check(RateLimiter *rl, uint64_t key, uint64_t now_ms) {
+    if (rl->rate == 0) return RATELIMIT_PASS;
+
+    size_t start = mix64(key) & (RATELIMIT_TABLE_SIZE - 1);
+    RateBucket *found = NULL;
+    RateBucket *free_slot = NULL;
+    RateBucket *oldest = NULL;
+
+    for (size_t i = 0; i < RATELIMIT_PROBES; i++) {
+        RateBucket *b = &rl->buckets[(start + i) & (RATELIMIT_TABLE_SIZE - 1)];
+        if (b->key == key) {
+            found = b;
+            break;
+        }
+        if (!free_slot && is_idle(rl, b, now_ms)) free_slot = b;
+        if (!oldest || b->last_ms < oldest->last_ms) oldest = b;
+    }
+
+    if (found) {
+        refill(rl, found, now_ms);
+    } else {
+        // New key starts with a full bucket; evict the least recently used if needed
+        found = free_slot ? free_slot : oldest;
+        found->key = key;
+        found->last_ms = now_ms;
+        found->tokens = rl->burst * TOKEN_UNIT;
+        found->limited = 0;
+    }
+
+    if (found->tokens >= TOKEN_UNIT) {
+        found->tokens -= TOKEN_UNIT;
+        return RATELIMIT_PASS;
+    }
+
+    found->limited++;
+    if (rl->slip && found->limited % rl->slip == 0)
+        return RATELIMIT_SLIP;
+    return RATELIMIT_DROP;
+}
+
+uint64_t ratelimit_client_key(const struct sockaddr_storage *addr) {
+    const uint8_t *bytes;
+    uint64_t key = 0;
+
+    if (addr->ss_family == AF_INET) {
+        bytes = (const uint8_t *)&((const struct sockaddr_in *)addr)->sin_addr;
+    } else {
+        const struct in6_addr *a6 = &((const struct sockaddr_in6 *)addr)->sin6_addr;
+        if (!IN6_IS_ADDR_V4MAPPED(a6)) {
+            // IPv6: family tag + first 56 bits
+            key = 6;
+            for (int i = 0; i < RATELIMIT_IPV6_PREFIX / 8; i++)
+                key = (key << 8) | a6->s6_addr[i];
+            return nonzero(key);
+        }
+        bytes = &a6->s6_addr[12];
+    }
+
+    // IPv4: family tag + first 24 bits
+    key = 4;
+    for (int i = 0; i < RATELIMIT_IPV4_PREFIX / 8; i++)
+        key = (key << 8) | bytes[i];
+    return nonzero(key);
+}
+
+uint64_t ratelimit_response_key(uint64_t client_key, const char *qname, uint16_t qtype) {
+    // FNV-1a over lowercased name and type
+    uint64_t h = 14695981039346656037ULL;
+    for (; *qname; ++qname) {
+        h ^= (uint8_t)tolower((unsigned char)*qname);
+        h *= 1099511628211ULL;
+    }
+    h ^= qtype;
+    h *= 1099511628211ULL;
+
+    return nonzero(h ^ mix64(client_key));
+}
+
+uint64_t ratelimit_group_key(uint64_t client_key, RateGroup group, uint32_t id) {
+    uint64_t tag = ((uint64_t)(group + 1) << 32) | id;
+    return nonzero(mix64(tag) ^ mix64(client_key));
+}
+
+uint64_t ratelimit_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
@@ -0,0 +1,154 @@
+#ifndef RATELIMIT_H
+#define RATELIMIT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+/**
+ * @brief Number of buckets in a rate limiter table (power of two).
+ *
+ * The table has a fixed size; idle buckets are reclaimed as they age and
+ * the least recently used bucket is evicted when a probe window is full.
+ */
+#define RATELIMIT_TABLE_SIZE 4096
+
+/**
+ * @brief Number of consecutive slots probed for a key.
+ */
+#define RATELIMIT_PROBES 8
+
+/**
+ * @brief Client prefix lengths that share one bucket (as in BIND RRL).
+ */
+#define RATELIMIT_IPV4_PREFIX 24
+#define RATELIMIT_IPV6_PREFIX 56
+
+/**
+ * @brief Default slip: every 2nd limited response gets a minimal reply.
+ */
+#define RATELIMIT_DEFAULT_SLIP 2
+
+/**
+ * @brief Result of a rate limit check.
+ */
+typedef enum {
+    RATELIMIT_PASS,  /**< Within limit, process normally */
+    RATELIMIT_DROP,  /**< Over limit, drop silently */
+    RATELIMIT_SLIP   /**< Over limit, answer with a minimal (REFUSED) response */
+} RateVerdict;
+
+/**
+ * @brief Response groups that share one bucket per client prefix.
+ *
+ * As in BIND RRL, responses that differ only in the queried name are
+ * grouped, so randomized names cannot avoid the limit.
+ */
+typedef enum {
+    RATELIMIT_GROUP_BLOCKED,  /**< Blocked by a filter rule, id = rule index */
+    RATELIMIT_GROUP_ERROR     /**< Error response, id = RCODE */
+} RateGroup;
+
+/**
+ * @struct RateBucket
+ * @brief Token bucket for one key (client prefix or response identity).
+ *
+ * Members:
+ *  - key:     Bucket key, 0 marks an unused slot.
+ *  - last_ms: Time of the last refill in milliseconds.
+ *  - tokens:  Available tokens in thousandths of a token.
+ *  - limited: Number of limited requests since the bucket was created.
+ */
+typedef struct {
+    uint64_t key;       /**< Bucket key, 0 = unused */
+    uint64_t last_ms;   /**< Last refill time */
+    uint32_t tokens;    /**< Available tokens (x1000) */
+    uint32_t limited;   /**< Limited requests, used for slip */
+} RateBucket;
+
+/**
+ * @struct RateLimiter
+ * @brief Fixed-size open-addressing table of token buckets.
+ *
+ * The proxy handles queries on a single thread, so the table needs no
+ * locking.
+ *
+ * Members:
+ *  - buckets: Bucket table.
+ *  - rate:    Tokens added per second; 0 disables the limiter.
+ *  - burst:   Bucket capacity in tokens.
+ *  - slip:    Every slip-th limited request gets RATELIMIT_SLIP (0 = never).
+ */
+typedef struct {
+    RateBucket buckets[RATELIMIT_TABLE_SIZE]; /**< Bucket table */
+    uint32_t rate;                            /**< Tokens per second, 0 = off */
+    uint32_t burst;                           /**< Bucket capacity */
+    uint32_t slip;                            /**< Slip ratio, 0 = always drop */
+} RateLimiter;
+
+/**
+ * @brief Initialize a rate limiter with empty buckets.
+ *
+ * @param rl     Rate limiter to initialize.
+ * @param rate   Allowed requests per second per key (0 disables limiting).
+ * @param burst  Bucket capacity; values below 1 are raised to 1.
+ * @param slip   Slip ratio for limited requests (0 = always drop).
+ */
+void ratelimit_init(RateLimiter *rl, uint32_t rate, uint32_t burst, uint32_t slip);
+
+/**
+ * @brief Charge one request to the bucket of a key.
+ *
+ * @param rl      Initialized rate limiter.
+ * @param key     Key from @ref ratelimit_client_key, @ref ratelimit_response_key
+ *                or @ref ratelimit_group_key.
+ * @param now_ms  Current time from @ref ratelimit_now_ms.
+ *
+ * @return RATELIMIT_PASS if a token was available, otherwise
+ *         RATELIMIT_DROP or RATELIMIT_SLIP according to the slip ratio.
+ */
+RateVerdict ratelimit_check(RateLimiter *rl, uint64_t key, uint64_t now_ms);
+
+/**
+ * @brief Build a key for the network prefix of a client address.
+ *
+ * IPv4 (including IPv4-mapped IPv6) addresses are reduced to
+ * @ref RATELIMIT_IPV4_PREFIX bits, IPv6 addresses to @ref RATELIMIT_IPV6_PREFIX.
+ *
+ * @param addr  Client address as returned by recvfrom.
+ *
+ * @return Non-zero bucket key.
+ */
+uint64_t ratelimit_client_key(const struct sockaddr_storage *addr);
+
+/**
+ * @brief Build a key for identical positive responses sent to one client prefix.
+ *
+ * A positive answer is identified by the question it answers, so repeated
+ * queries for the same name and type from one prefix share a bucket.
+ *
+ * @param client_key  Key from @ref ratelimit_client_key.
+ * @param qname       Queried domain name (compared case-insensitively).
+ * @param qtype       Query type.
+ *
+ * @return Non-zero bucket key.
+ */
+uint64_t ratelimit_response_key(uint64_t client_key, const char *qname, uint16_t qtype);
+
+/**
+ * @brief Build a key for a group of responses sent to one client prefix.
+ *
+ * @param client_key  Key from @ref ratelimit_client_key.
+ * @param group       Response group.
+ * @param id          Identifier within the group (filter rule index or RCODE).
+ *
+ * @return Non-zero bucket key.
+ */
+uint64_t ratelimit_group_key(uint64_t client_key, RateGroup group, uint32_t id);
+
+/**
+ * @brief Current monotonic time in milliseconds.
+ */
+uint64_t ratelimit_now_ms(void);
+
+#endif // RATELIMIT_H
@@ -0,0 +1,111 @@
+/************************************
+*Jméno autora: Tomáš Zavadil
+*Login: xzavadt00
+************************************/
+
+#define _DEFAULT_SOURCE // for SO_TIMESTAMPNS / SCM_TIMESTAMPNS
+#include <string.h>
+#include <sys/socket.h>
+#include "trace.h"
+
+// Names of the stage segments in the slow-query log (indexed by ending stage)
+static const char *stage_names[TRACE_STAGE_COUNT] = {
+    [TRACE_KERNEL_RX]         = "kernel",
+    [TRACE_RECEIVED]          = "queue",
+    [TRACE_PARSED]            = "parse",
+    [TRACE_FILTERED]          = "filter",
+    [TRACE_UPSTREAM_SENT]     = "upstream_send",
+    [TRACE_UPSTREAM_RECEIVED] = "upstream",
+    [TRACE_SENT]              = "reply",
+};
+
+// Difference of two timestamps in milliseconds
+static double elapsed_ms(const struct timespec *from, const struct timespec *to) {
+    return (to->tv_sec - from->tv_sec) * 1e3 + (to->tv_nsec - from->tv_nsec) / 1e6;
+}
+
+static bool reached(const QueryTrace *trace, TraceStage stage) {
+    return trace->stamps[stage].tv_sec != 0;
+}
+
+bool tracer_init(Tracer *tracer, int sock, int threshold_ms, int sample,
+                 const char *log_path)
+{
+    memset(tracer, 0, sizeof(*tracer));
+    if (threshold_ms < 0) return true;
+
+    tracer->log = stderr;
+    if (log_path) {
+        tracer->log = fopen(log_path, "a");
+        if (!tracer->log) return false;
+        setvbuf(tracer->log, NULL, _IOLBF, 0);
+    }
+
+    // Kernel timestamps are best effort, user-space stamps still work without them
+    int on = 1;
+    setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+
+    tracer->enabled = true;
+    tracer->threshold_ms = threshold_ms;
+    tracer->sample = sample > 1 ? (unsigned)sample : 1;
+    return true;
+}
+
+void tracer_close(Tracer *tracer) {
+    if (tracer->log && tracer->log != stderr) fclose(tracer->log);
+    tracer->log = NULL;
+    tracer->enabled = false;
+}
+
+void trace_start(Tracer *tracer, QueryTrace *trace, const struct msghdr *msg) {
+    if (++tracer->counter < tracer->sample) return;
+    tracer->counter = 0;
+
+    memset(trace->stamps, 0, sizeof(trace->stamps));
+    trace->active = true;
+
+    for (struct cmsghdr *c = CMSG_FIRSTHDR((struct msghdr *)msg); c;
+         c = CMSG_NXTHDR((struct msghdr *)msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(&trace->stamps[TRACE_KERNEL_RX], CMSG_DATA(c), sizeof(struct timespec));
+            break;
+        }
+    }
+
+    trace_stamp(trace, TRACE_RECEIVED);
+}
+
+void trace_stamp(QueryTrace *trace, TraceStage stage) {
+    clock_gettime(CLOCK_REALTIME, &trace->stamps[stage]);
+}
+
+void trace_report(Tracer *tracer, QueryTrace *trace, const DnsQuestion *q,
+                  const char *outcome)
+{
+    trace_stamp(trace, TRACE_SENT);
+    trace->active = false;
+
+    TraceStage first = reached(trace, TRACE_KERNEL_RX) ? TRACE_KERNEL_RX : TRACE_RECEIVED;
+    double total = elapsed_ms(&trace->stamps[first], &trace->stamps[TRACE_SENT]);
+    if (total < tracer->threshold_ms) return;
+
+    fprintf(tracer->log, "Slow query: %s %s (%s) total=%.3fms",
+            q->qname, dns_type_to_string(q->qtype), outcome, total);
+
+    // Time of each stage since the previous reached one
+    TraceStage prev = first;
+    for (int s = TRACE_RECEIVED; s < TRACE_STAGE_COUNT; s++) {
+        if (!reached(trace, s)) {
+            fprintf(tracer->log, " %s=-", stage_names[s]);
+            continue;
+        }
+        if (s == (int)prev) {
+            fprintf(tracer->log, " %s=-", stage_names[s]);
+            continue;
+        }
+        fprintf(tracer->log, " %s=%.3fms", stage_names[s],
+                elapsed_ms(&trace->stamps[prev], &trace->stamps[s]));
+        prev = s;
+    }
+    fputc('\n', tracer->log);
+}
@@ -0,0 +1,148 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <time.h>
+#include <sys/socket.h>
+#include "dns.h"
+
+/**
+ * @brief Size of the recvmsg control buffer needed for a kernel timestamp.
+ */
+#define TRACE_CONTROL_SIZE 64
+
+/**
+ * @brief Processing stages timestamped for a traced query, in order.
+ */
+typedef enum {
+    TRACE_KERNEL_RX,          /**< Datagram received by the kernel (SO_TIMESTAMPNS) */
+    TRACE_RECEIVED,           /**< Datagram read by the proxy */
+    TRACE_PARSED,             /**< Question section parsed */
+    TRACE_FILTERED,           /**< Local answer / filter decision made */
+    TRACE_UPSTREAM_SENT,      /**< Query sent to the upstream resolver */
+    TRACE_UPSTREAM_RECEIVED,  /**< Upstream response received */
+    TRACE_SENT,               /**< Response sent to the client */
+    TRACE_STAGE_COUNT
+} TraceStage;
+
+/**
+ * @struct QueryTrace
+ * @brief Stage timestamps of a single query.
+ *
+ * Members:
+ *  - active: True if this query was selected for tracing.
+ *  - stamps: CLOCK_REALTIME timestamp per stage, zero if the stage was not reached.
+ */
+typedef struct {
+    bool active;                                /**< Query is being traced */
+    struct timespec stamps[TRACE_STAGE_COUNT];  /**< Timestamps per stage */
+} QueryTrace;
+
+/**
+ * @struct Tracer
+ * @brief Tracing configuration and slow-query log.
+ *
+ * Members:
+ *  - enabled:      Tracing is turned on.
+ *  - threshold_ms: Traced queries at least this slow are logged.
+ *  - sample:       Every sample-th query is traced.
+ *  - counter:      Queries seen since the last traced one.
+ *  - log:          Slow-query log stream.
+ */
+typedef struct {
+    bool enabled;           /**< Tracing turned on */
+    double threshold_ms;    /**< Slow-query threshold */
+    unsigned sample;        /**< Sampling period */
+    unsigned counter;       /**< Sampling counter */
+    FILE *log;              /**< Slow-query log stream */
+} Tracer;
+
+/**
+ * @brief Initialize the tracer and enable kernel receive timestamps.
+ *
+ * With @p threshold_ms < 0 tracing stays disabled and no socket option
+ * is set; @ref trace_begin then only clears the trace.
+ *
+ * @param tracer        Tracer to initialize.
+ * @param sock          Listening socket to request SO_TIMESTAMPNS on.
+ * @param threshold_ms  Slow-query threshold in milliseconds (< 0 = off).
+ * @param sample        Trace every sample-th query (values below 1 mean every query).
+ * @param log_path      Slow-query log file (appended), or NULL for stderr.
+ *
+ * @return true on success, false if the log file cannot be opened.
+ */
+bool tracer_init(Tracer *tracer, int sock, int threshold_ms, int sample,
+                 const char *log_path);
+
+/**
+ * @brief Close the slow-query log if it was opened by @ref tracer_init.
+ *
+ * @param tracer  Initialized tracer.
+ */
+void tracer_close(Tracer *tracer);
+
+/**
+ * @brief Start tracing a sampled query (called by @ref trace_begin).
+ */
+void trace_start(Tracer *tracer, QueryTrace *trace, const struct msghdr *msg);
+
+/**
+ * @brief Store the current time for a stage (called by @ref trace_mark).
+ */
+void trace_stamp(QueryTrace *trace, TraceStage stage);
+
+/**
+ * @brief Log a finished traced query if it was slow (called by @ref trace_finish).
+ */
+void trace_report(Tracer *tracer, QueryTrace *trace, const DnsQuestion *q,
+                  const char *outcome);
+
+/**
+ * @brief Start tracing a received query if it is sampled.
+ *
+ * Records the kernel receive time from the SCM_TIMESTAMPNS control
+ * message of @p msg (if present) and the current time as TRACE_RECEIVED.
+ * With tracing disabled this is only an inline flag test.
+ *
+ * @param tracer  Initialized tracer.
+ * @param trace   Trace of the new query.
+ * @param msg     Message header filled by recvmsg.
+ */
+static inline void trace_begin(Tracer *tracer, QueryTrace *trace,
+                               const struct msghdr *msg)
+{
+    trace->active = false;
+    if (tracer->enabled) trace_start(tracer, trace, msg);
+}
+
+/**
+ * @brief Timestamp a processing stage of a traced query.
+ *
+ * Does nothing if @p trace is NULL or the query is not traced.
+ *
+ * @param trace  Trace of the query.
+ * @param stage  Stage that was just completed.
+ */
+static inline void trace_mark(QueryTrace *trace, TraceStage stage) {
+    if (trace && trace->active) trace_stamp(trace, stage);
+}
+
+/**
+ * @brief Mark the response as sent and log the query if it was slow.
+ *
+ * The log line contains the total time and the time spent in each stage;
+ * stages that were not reached are shown as "-".
+ *
+ * @param tracer   Initialized tracer.
+ * @param trace    Trace of the query.
+ * @param q        Parsed question of the query.
+ * @param outcome  Short description of how the query was answered.
+ */
+static inline void trace_finish(Tracer *tracer, QueryTrace *trace,
+                                const DnsQuestion *q, const char *outcome)
+{
+    if (trace->active) trace_report(tracer, trace, q, outcome);
+}
+
+#endif // TRACE_H
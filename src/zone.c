@@ -0,0 +1,380 @@
+/************************************
+*Jméno autora: Tomáš Zavadil
+*Login: xzavadt00
+************************************/
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <arpa/inet.h>
+#include "zone.h"
+
+#define MAX_LINE_LEN 512
+#define ZONE_INITIAL_BUCKETS 64
+// Records of one name plus the CNAME chain leading to it, guaranteed by zone_load
+#define ZONE_MAX_RESPONSE_RECORDS (ZONE_MAX_ANSWERS + ZONE_MAX_CNAME_CHAIN)
+
+// Helper: convert string to lowercase in-place
+static void strtolower_inplace(char *s) {
+    for (; *s; ++s) *s = tolower((unsigned char)*s);
+}
+
+// Helper: strip trailing dot and lowercase a domain name in-place
+static void normalize_name(char *s) {
+    size_t len = strlen(s);
+    if (len > 1 && s[len - 1] == '.') s[len - 1] = '\0';
+    strtolower_inplace(s);
+}
+
+// FNV-1a hash of a (normalized) domain name
+static size_t zone_hash(const char *name) {
+    uint32_t h = 2166136261u;
+    for (; *name; ++name) {
+        h ^= (uint8_t)*name;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Double the bucket array and rehash all records
+static bool zone_grow(ZoneTable *zone) {
+    size_t new_count = zone->bucket_count * 2;
+    ZoneRecord **new_buckets = calloc(new_count, sizeof(*new_buckets));
+    if (!new_buckets) return false;
+
+    for (size_t i = 0; i < zone->bucket_count; i++) {
+        ZoneRecord *r = zone->buckets[i];
+        while (r) {
+            ZoneRecord *next = r->next;
+            size_t b = zone_hash(r->name) & (new_count - 1);
+            r->next = new_buckets[b];
+            new_buckets[b] = r;
+            r = next;
+        }
+    }
+
+    free(zone->buckets);
+    zone->buckets = new_buckets;
+    zone->bucket_count = new_count;
+    return true;
+}
+
+// Create a record and insert it into the table
+static bool zone_add(ZoneTable *zone, const char *name, uint16_t type,
+                     uint32_t ttl, const uint8_t *rdata, uint16_t rdlength,
+                     const char *target)
+{
+    uint8_t wire[256];
+    if (dns_encode_name(name, wire, sizeof(wire)) < 0) return false;
+
+    if ((size_t)zone->count >= zone->bucket_count && !zone_grow(zone))
+        return false;
+
+    ZoneRecord *r = calloc(1, sizeof(*r));
+    if (!r) return false;
+
+    r->name = strdup(name);
+    r->rdata = malloc(rdlength);
+    r->target = target ? strdup(target) : NULL;
+    if (!r->name || !r->rdata || (target && !r->target)) {
+        free(r->name);
+        free(r->rdata);
+        free(r->target);
+        free(r);
+        return false;
+    }
+
+    r->type = type;
+    r->ttl = ttl;
+    r->rdlength = rdlength;
+    memcpy(r->rdata, rdata, rdlength);
+
+    size_t b = zone_hash(r->name) & (zone->bucket_count - 1);
+    r->next = zone->buckets[b];
+    zone->buckets[b] = r;
+    zone->count++;
+    return true;
+}
+
+// Parse "address name [alias ...]"
+static bool zone_parse_hosts_line(ZoneTable *zone, const char *address,
+                                  char **save)
+{
+    uint8_t rdata[16];
+    uint16_t type, rdlength;
+
+    if (inet_pton(AF_INET, address, rdata) == 1) {
+        type = DNS_TYPE_A;
+        rdlength = 4;
+    } else if (inet_pton(AF_INET6, address, rdata) == 1) {
+        type = DNS_TYPE_AAAA;
+        rdlength = 16;
+    } else {
+        return false;
+    }
+
+    char *name = strtok_r(NULL, " \t", save);
+    if (!name) return false;
+
+    for (; name; name = strtok_r(NULL, " \t", save)) {
+        if (name[0] == '#') break; // trailing comment
+        normalize_name(name);
+        if (!zone_add(zone, name, type, ZONE_DEFAULT_TTL, rdata, rdlength, NULL))
+            return false;
+    }
+    return true;
+}
+
+// Parse "name [ttl] type value"
+static bool zone_parse_record_line(ZoneTable *zone, char *name, char **save) {
+    char *token = strtok_r(NULL, " \t", save);
+    if (!token) return false;
+
+    uint32_t ttl = ZONE_DEFAULT_TTL;
+    if (isdigit((unsigned char)token[0])) {
+        char *end;
+        unsigned long value = strtoul(token, &end, 10);
+        if (*end != '\0' || value > 0x7FFFFFFFul) return false;
+        ttl = (uint32_t)value;
+        token = strtok_r(NULL, " \t", save);
+        if (!token) return false;
+    }
+
+    uint16_t type = dns_type_from_string(token);
+    char *value = strtok_r(NULL, " \t", save);
+    if (!value) return false;
+
+    char *rest = strtok_r(NULL, " \t", save);
+    if (rest && rest[0] != '#') return false;
+
+    normalize_name(name);
+
+    uint8_t rdata[256];
+    switch (type) {
+        case DNS_TYPE_A:
+            if (inet_pton(AF_INET, value, rdata) != 1) return false;
+            return zone_add(zone, name, type, ttl, rdata, 4, NULL);
+
+        case DNS_TYPE_AAAA:
+            if (inet_pton(AF_INET6, value, rdata) != 1) return false;
+            return zone_add(zone, name, type, ttl, rdata, 16, NULL);
+
+        case DNS_TYPE_CNAME: {
+            normalize_name(value);
+            int len = dns_encode_name(value, rdata, sizeof(rdata));
+            if (len < 0) return false;
+            return zone_add(zone, name, type, ttl, rdata, (uint16_t)len, value);
+        }
+
+        default:
+            return false; // unsupported record type
+    }
+}
+
+// Find the CNAME record of a name, reports whether the name exists at all
+static const ZoneRecord *zone_find_cname(const ZoneTable *zone, const char *name,
+                                         bool *exists)
+{
+    size_t b = zone_hash(name) & (zone->bucket_count - 1);
+    const ZoneRecord *cname = NULL;
+    *exists = false;
+
+    for (const ZoneRecord *r = zone->buckets[b]; r; r = r->next) {
+        if (strcmp(r->name, name) != 0) continue;
+        *exists = true;
+        if (r->type == DNS_TYPE_CNAME) cname = r;
+    }
+    return cname;
+}
+
+// No name may have more records than fit into one answer, and a CNAME must be
+// the only record of its name (RFC 1034 3.6.2)
+static bool zone_check_names(const ZoneTable *zone, const char *filename) {
+    for (size_t i = 0; i < zone->bucket_count; i++) {
+        for (const ZoneRecord *r = zone->buckets[i]; r; r = r->next) {
+            int records = 0;
+            for (const ZoneRecord *o = zone->buckets[i]; o; o = o->next) {
+                if (strcmp(o->name, r->name) == 0) records++;
+            }
+
+            if (records > ZONE_MAX_ANSWERS) {
+                fprintf(stderr, "Jméno %s má v souboru %s více než %d záznamů\n",
+                        r->name, filename, ZONE_MAX_ANSWERS);
+                return false;
+            }
+            if (r->type == DNS_TYPE_CNAME && records > 1) {
+                fprintf(stderr, "Jméno %s má v souboru %s kromě CNAME další záznamy\n",
+                        r->name, filename);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Every CNAME chain must end at a name in the table within ZONE_MAX_CNAME_CHAIN
+// hops: stub clients do not follow CNAMEs out of an authoritative answer
+static bool zone_check_cnames(const ZoneTable *zone, const char *filename) {
+    for (size_t i = 0; i < zone->bucket_count; i++) {
+        for (const ZoneRecord *r = zone->buckets[i]; r; r = r->next) {
+            if (r->type != DNS_TYPE_CNAME) continue;
+
+            const ZoneRecord *cname = r;
+            int hops = 0;
+            while (cname) {
+                bool exists;
+                const char *target = cname->target;
+                cname = zone_find_cname(zone, target, &exists);
+
+                if (!exists) {
+                    fprintf(stderr, "Cíl CNAME %s -> %s není v souboru %s\n",
+                            r->name, target, filename);
+                    return false;
+                }
+                if (cname && ++hops >= ZONE_MAX_CNAME_CHAIN) {
+                    fprintf(stderr, "Smyčka nebo příliš dlouhý řetězec CNAME u %s v souboru %s\n",
+                            r->name, filename);
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Load overrides file
+bool zone_load(const char *filename, ZoneTable *out) {
+    out->count = 0;
+    out->bucket_count = ZONE_INITIAL_BUCKETS;
+    out->buckets = calloc(out->bucket_count, sizeof(*out->buckets));
+    if (!out->buckets) return false;
+
+    FILE *f = fopen(filename, "r");
+    if (!f) {
+        zone_free(out);
+        return false;
+    }
+
+    char line[MAX_LINE_LEN];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+
+        // remove trailing newline
+        line[strcspn(line, "\r\n")] = '\0';
+
+        char *save;
+        char *first = strtok_r(line, " \t", &save);
+
+        // skip empty lines or comments
+        if (!first || first[0] == '#') continue;
+
+        // hosts-style lines start with an address
+        bool ok;
+        uint8_t addr[16];
+        if (inet_pton(AF_INET, first, addr) == 1 || inet_pton(AF_INET6, first, addr) == 1)
+            ok = zone_parse_hosts_line(out, first, &save);
+        else
+            ok = zone_parse_record_line(out, first, &save);
+
+        if (!ok) {
+            fprintf(stderr, "Neplatný záznam v souboru %s na řádku %d\n",
+                    filename, line_no);
+            fclose(f);
+            zone_free(out);
+            return false;
+        }
+    }
+
+    fclose(f);
+
+    if (!zone_check_names(out, filename) || !zone_check_cnames(out, filename)) {
+        zone_free(out);
+        return false;
+    }
+    return true;
+}
+
+// Free zone table
+void zone_free(ZoneTable *zone) {
+    for (size_t i = 0; i < zone->bucket_count; i++) {
+        ZoneRecord *r = zone->buckets[i];
+        while (r) {
+            ZoneRecord *next = r->next;
+            free(r->name);
+            free(r->rdata);
+            free(r->target);
+            free(r);
+            r = next;
+        }
+    }
+    free(zone->buckets);
+    zone->buckets = NULL;
+    zone->bucket_count = 0;
+    zone->count = 0;
+}
+
+// Answer query from the table
+bool zone_answer(const ZoneTable *zone, const DnsQuestion *q,
+                 const uint8_t *request, int request_len,
+                 uint8_t *response, int *response_len, int response_size)
+{
+    if (zone->count == 0) return false;
+
+    char qname[sizeof(q->qname)];
+    strcpy(qname, q->qname);
+    normalize_name(qname);
+
+    DnsRecord answers[ZONE_MAX_RESPONSE_RECORDS];
+    int count = 0;
+    const char *current = qname;
+
+    for (int hop = 0; hop <= ZONE_MAX_CNAME_CHAIN; hop++) {
+        size_t b = zone_hash(current) & (zone->bucket_count - 1);
+        bool exists = false;
+        bool matched = false;
+        const ZoneRecord *cname = NULL;
+
+        for (const ZoneRecord *r = zone->buckets[b]; r; r = r->next) {
+            if (strcmp(r->name, current) != 0) continue;
+            exists = true;
+
+            if (r->type == q->qtype || q->qtype == DNS_TYPE_ANY) {
+                matched = true;
+                if (count < ZONE_MAX_RESPONSE_RECORDS) {
+                    answers[count++] = (DnsRecord){
+                        .name = hop == 0 ? NULL : current,
+                        .type = r->type, .ttl = r->ttl,
+                        .rdlength = r->rdlength, .rdata = r->rdata
+                    };
+                }
+            } else if (r->type == DNS_TYPE_CNAME) {
+                cname = r;
+            }
+        }
+
+        // Name not overridden locally: leave it to filter/upstream
+        if (hop == 0 && !exists) return false;
+
+        // Done, unless the name is an alias we can follow
+        if (matched || !cname || count >= ZONE_MAX_RESPONSE_RECORDS) break;
+
+        answers[count++] = (DnsRecord){
+            .name = hop == 0 ? NULL : current,
+            .type = cname->type, .ttl = cname->ttl,
+            .rdlength = cname->rdlength, .rdata = cname->rdata
+        };
+        current = cname->target;
+    }
+
+    // The name is overridden: never fall through to the filter or upstream
+    if (!dns_build_answer_response(request, request_len, response,
+                                   response_len, response_size,
+                                   answers, count)) {
+        dns_build_error_response(request, request_len, response,
+                                 response_len, 2); // SERVFAIL
+    }
+    return true;
+}
@@ -0,0 +1,122 @@
+#ifndef ZONE_H
+#define ZONE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "dns.h"
+
+/**
+ * @brief TTL used for records that do not specify one (hosts-style lines).
+ */
+#define ZONE_DEFAULT_TTL 300
+
+/**
+ * @brief Maximum number of records of one name, files with more are rejected.
+ */
+#define ZONE_MAX_ANSWERS 64
+
+/**
+ * @brief Maximum number of CNAME records followed within the table for one answer.
+ */
+#define ZONE_MAX_CNAME_CHAIN 8
+
+/**
+ * @struct ZoneRecord
+ * @brief A single local override record (A, AAAA or CNAME).
+ *
+ * Records are chained per hash bucket through @ref next.
+ *
+ * Members:
+ *  - name:     Lowercased owner name without trailing dot.
+ *  - type:     DNS_TYPE_A, DNS_TYPE_AAAA or DNS_TYPE_CNAME.
+ *  - ttl:      Time to live in seconds.
+ *  - rdlength: Length of @ref rdata in bytes.
+ *  - rdata:    Record data in wire format.
+ *  - target:   CNAME target as a C string (NULL for address records).
+ *  - next:     Next record in the same hash bucket.
+ */
+typedef struct ZoneRecord {
+    char *name;                /**< Owner name (lowercase, no trailing dot) */
+    uint16_t type;             /**< Record type */
+    uint32_t ttl;              /**< Time to live in seconds */
+    uint16_t rdlength;         /**< Length of rdata */
+    uint8_t *rdata;            /**< Wire-format record data */
+    char *target;              /**< CNAME target, NULL otherwise */
+    struct ZoneRecord *next;   /**< Next record in bucket chain */
+} ZoneRecord;
+
+/**
+ * @struct ZoneTable
+ * @brief Hash-indexed table of local authoritative overrides.
+ *
+ * Memory ownership:
+ *  All buckets and records are dynamically allocated and must be released
+ *  with @ref zone_free after use.
+ *
+ * Members:
+ *  - buckets:      Array of bucket chains (power-of-two length).
+ *  - bucket_count: Number of buckets.
+ *  - count:        Number of stored records.
+ */
+typedef struct {
+    ZoneRecord **buckets;  /**< Bucket chains */
+    size_t bucket_count;   /**< Number of buckets */
+    int count;             /**< Number of stored records */
+} ZoneTable;
+
+/**
+ * @brief Load an overrides file into a hash-indexed table.
+ *
+ * Empty lines and comment lines starting with `#` are ignored. Two line
+ * formats are accepted:
+ *   `10.0.0.5 svc.internal [alias ...]`      – hosts-style, A or AAAA
+ *                                              with @ref ZONE_DEFAULT_TTL
+ *   `svc.internal [ttl] A|AAAA|CNAME value`  – zone-style record
+ *
+ * Each name may have at most @ref ZONE_MAX_ANSWERS records, and a name with
+ * a CNAME record may have no other records (RFC 1034 3.6.2). CNAME targets
+ * must be names defined in the same file, and chains may be at most
+ * @ref ZONE_MAX_CNAME_CHAIN records long. Out-of-table targets and CNAME
+ * loops are rejected, because stub clients do not follow a CNAME themselves.
+ *
+ * @param filename  Path to the overrides file.
+ * @param out       Pointer to ZoneTable to be populated.
+ *
+ * @return true on success, false on failure (I/O error, invalid line,
+ *         too many records of a name, CNAME next to other records,
+ *         invalid CNAME chain, out of memory).
+ */
+bool zone_load(const char *filename, ZoneTable *out);
+
+/**
+ * @brief Free all buckets and records of a ZoneTable.
+ *
+ * @param zone  Pointer to a ZoneTable previously initialized by @ref zone_load.
+ */
+void zone_free(ZoneTable *zone);
+
+/**
+ * @brief Answer a query directly from the overrides table.
+ *
+ * If the queried name exists in the table, an authoritative response is
+ * built: matching records, or the CNAME chain followed to its end within
+ * the table (guaranteed by @ref zone_load) for other types, or an empty
+ * NODATA answer when the name has no records of the requested type.
+ *
+ * @param zone           Pointer to initialized ZoneTable.
+ * @param q              Parsed question of the request.
+ * @param request        Original DNS request.
+ * @param request_len    Length of the request in bytes.
+ * @param response       Buffer to write the generated DNS response.
+ * @param response_len   Output: length of the generated response.
+ * @param response_size  Maximum size of the response (client's UDP payload size).
+ *
+ * @return true if the name is in the table (a SERVFAIL response is built if
+ *         the answer cannot be encoded), false if it is not.
+ */
+bool zone_answer(const ZoneTable *zone, const DnsQuestion *q,
+                 const uint8_t *request, int request_len,
+                 uint8_t *response, int *response_len, int response_size);
+
+#endif // ZONE_H
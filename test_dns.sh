@@ -33,6 +33,9 @@ cleanup() {
     [[ -f "empty_filters.txt" ]] && rm -f "empty_filters.txt"
     [[ -f "proxy.log" ]] && rm -f "proxy.log"
     [[ -f "test_output.txt" ]] && rm -f "test_output.txt"
+    [[ -f "test_zone.txt" ]] && rm -f "test_zone.txt"
+    [[ -f "test_slow.log" ]] && rm -f "test_slow.log"
+    [[ -e "test_control.sock" ]] && rm -f "test_control.sock"
 }
 
 trap cleanup EXIT INT TERM
@@ -51,6 +54,9 @@ ads.example.com
 
 malware.net
 tracking.site
+
+# Rule restricted to a single query type
+example.org AAAA
 EOF
 }
 
@@ -536,13 +542,24 @@ echo ""
 # TEST 9: Query Type Handling
 # ============================================================
 echo "======================================================================"
-echo "TEST 9: Query Type Handling (Only A Records Supported)"
-echo "======================================================================"
-
-check_dns "google.com" "A" "NOERROR" "Type A query (supported)"
-check_dns "google.com" "AAAA" "NOTIMP" "Type AAAA query (not supported)"
-check_dns "google.com" "MX" "NOTIMP" "Type MX query (not supported)"
-check_dns "google.com" "TXT" "NOTIMP" "Type TXT query (not supported)"
+echo "TEST 9: Query Type Handling (All Types Forwarded)"
+echo "======================================================================"
+
+check_dns "google.com" "A" "NOERROR" "Type A query"
+check_dns "google.com" "AAAA" "NOERROR" "Type AAAA query"
+check_dns "google.com" "HTTPS" "NOERROR" "Type HTTPS query"
+check_dns "google.com" "MX" "NOERROR" "Type MX query"
+check_dns "google.com" "TXT" "NOERROR" "Type TXT query"
+check_dns "blocked.com" "AAAA" "NXDOMAIN" "Blocked domain, AAAA query"
+check_dns "example.org" "A" "NOERROR" "Type-restricted rule, other type"
+# A forwarded AAAA answer is NOERROR too, so the rule must also leave the answer empty
+header=$(dig @"$PROXY_HOST" -p "$PROXY_PORT" example.org AAAA +time=5 +tries=2 2>/dev/null | \
+    grep -E "status:|flags:" | tr '\n' ' ')
+if echo "$header" | grep -q "status: NOERROR" && echo "$header" | grep -q "ANSWER: 0,"; then
+    pass "Type-restricted rule, matching type (NODATA): example.org (AAAA) → NOERROR, ANSWER: 0"
+else
+    fail "Type-restricted rule, matching type (NODATA): example.org (AAAA) → Got: $header"
+fi
 
 echo ""
 
@@ -647,6 +664,247 @@ fi
 
 echo ""
 
+# ============================================================
+# TEST 14: Local Overrides
+# ============================================================
+echo "======================================================================"
+echo "TEST 14: Local Overrides (-z zone_file)"
+echo "======================================================================"
+
+stop_proxy
+cat > "test_zone.txt" << 'EOF'
+# hosts-style and zone-style overrides
+10.0.0.5 svc.internal
+api.internal 60 CNAME svc.internal
+blocked.com 30 A 10.0.0.6
+EOF
+
+if start_proxy "8.8.8.8" "$PROXY_PORT" "$FILTER_FILE" "-z test_zone.txt"; then
+    check_dns "svc.internal" "A" "NOERROR" "Hosts-style override"
+    check_dns "svc.internal" "AAAA" "NOERROR" "Override without record of type (NODATA)"
+    check_dns "api.internal" "A" "NOERROR" "CNAME override"
+    check_dns "blocked.com" "A" "NOERROR" "Override takes precedence over filter"
+    check_dns "sub.blocked.com" "A" "NXDOMAIN" "Non-overridden name still filtered"
+
+    result=$(dig @"$PROXY_HOST" -p "$PROXY_PORT" api.internal A +short +time=2 +tries=1 2>/dev/null | tail -n1)
+    if [[ "$result" == "10.0.0.5" ]]; then
+        pass "CNAME chain resolved locally: api.internal → $result"
+    else
+        fail "CNAME chain not resolved locally (got: '$result')"
+    fi
+
+    # EDNS padding makes the query larger than a plain 512-byte response
+    result=$(dig @"$PROXY_HOST" -p "$PROXY_PORT" svc.internal A +padding=1024 +short +time=2 +tries=1 2>/dev/null | tail -n1)
+    if [[ "$result" == "10.0.0.5" ]]; then
+        pass "Large padded query answered locally: svc.internal → $result"
+    else
+        fail "Large padded query not answered locally (got: '$result')"
+    fi
+    stop_proxy
+else
+    fail "Could not start with zone file"
+fi
+
+info "Testing invalid CNAME chains in zone file..."
+printf 'ext.internal CNAME www.google.com\n' > "test_zone.txt"
+if ./dns -s 8.8.8.8 -p "$PROXY_PORT" -f "$FILTER_FILE" -z test_zone.txt > test_output.txt 2>&1; then
+    fail "Should reject CNAME target outside the zone file"
+else
+    pass "Rejected CNAME target outside the zone file"
+fi
+printf 'loop1.internal CNAME loop2.internal\nloop2.internal CNAME loop1.internal\n' > "test_zone.txt"
+if ./dns -s 8.8.8.8 -p "$PROXY_PORT" -f "$FILTER_FILE" -z test_zone.txt > test_output.txt 2>&1; then
+    fail "Should reject CNAME loop"
+else
+    pass "Rejected CNAME loop"
+fi
+printf 'x.internal CNAME svc.internal\nx.internal A 10.0.0.7\nsvc.internal A 10.0.0.5\n' > "test_zone.txt"
+if ./dns -s 8.8.8.8 -p "$PROXY_PORT" -f "$FILTER_FILE" -z test_zone.txt > test_output.txt 2>&1; then
+    fail "Should reject CNAME next to other records of the same name"
+else
+    pass "Rejected CNAME next to other records of the same name"
+fi
+for i in $(seq 1 65); do echo "10.1.0.$i many.internal"; done > "test_zone.txt"
+if ./dns -s 8.8.8.8 -p "$PROXY_PORT" -f "$FILTER_FILE" -z test_zone.txt > test_output.txt 2>&1; then
+    fail "Should reject a name with too many records"
+else
+    pass "Rejected a name with too many records"
+fi
+
+for i in $(seq 1 40); do echo "10.1.0.$i many.internal"; done > "test_zone.txt"
+if start_proxy "8.8.8.8" "$PROXY_PORT" "$FILTER_FILE" "-z test_zone.txt"; then
+    flags=$(dig @"$PROXY_HOST" -p "$PROXY_PORT" many.internal A +bufsize=4096 +time=2 +tries=1 +ignore 2>/dev/null | grep "flags:")
+    if echo "$flags" | grep -q "ANSWER: 40" && ! echo "$flags" | grep -q " tc"; then
+        pass "Large local answer sized by EDNS payload (40 records, no TC)"
+    else
+        fail "Large local answer truncated despite EDNS payload: $flags"
+    fi
+    stop_proxy
+else
+    fail "Could not start with zone file"
+fi
+rm -f "test_zone.txt"
+
+echo ""
+
+# ============================================================
+# TEST 15: Rate Limiting
+# ============================================================
+echo "======================================================================"
+echo "TEST 15: Rate Limiting (-r / -R)"
+echo "======================================================================"
+
+if start_proxy "8.8.8.8" "$PROXY_PORT" "$FILTER_FILE" "-R 5"; then
+    answered=0
+    refused=0
+    for i in {1..30}; do
+        out=$(dig @"$PROXY_HOST" -p "$PROXY_PORT" "x$i.blocked.com" A +time=1 +tries=1 2>/dev/null)
+        grep -q "status: NXDOMAIN" <<< "$out" && answered=$((answered + 1))
+        grep -q "status: REFUSED" <<< "$out" && refused=$((refused + 1))
+    done
+    if (( answered < 30 && refused > 0 )); then
+        pass "Response rate limit (random blocked names): $answered answered, $refused refused of 30"
+    else
+        fail "Response rate limit not applied ($answered answered, $refused refused of 30)"
+    fi
+    check_dns "google.com" "A" "NOERROR" "Other names unaffected by response limit"
+    stop_proxy
+else
+    fail "Could not start with response rate limit"
+fi
+
+if start_proxy "8.8.8.8" "$PROXY_PORT" "$FILTER_FILE" "-r 10"; then
+    answered=0
+    for i in {1..30}; do
+        dig @"$PROXY_HOST" -p "$PROXY_PORT" "q$i.blocked.com" A +time=1 +tries=1 2>/dev/null | \
+            grep -q "status:" && answered=$((answered + 1))
+    done
+    if (( answered < 30 )); then
+        pass "Query rate limit: $answered of 30 queries answered"
+    else
+        fail "Query rate limit not applied (all 30 queries answered)"
+    fi
+    stop_proxy
+else
+    fail "Could not start with query rate limit"
+fi
+
+echo ""
+
+# ============================================================
+# TEST 16: Query Tracing
+# ============================================================
+echo "======================================================================"
+echo "TEST 16: Query Tracing and Slow-Query Log (-t / -S / -l)"
+echo "======================================================================"
+
+rm -f "test_slow.log"
+if start_proxy "8.8.8.8" "$PROXY_PORT" "$FILTER_FILE" "-t 0 -S 2 -l test_slow.log"; then
+    for i in {1..4}; do
+        dig @"$PROXY_HOST" -p "$PROXY_PORT" "google.com" A +time=2 +tries=1 > /dev/null 2>&1
+    done
+    stop_proxy
+
+    logged=$(grep -c "^Slow query: google.com A (forwarded)" test_slow.log 2>/dev/null)
+    if [[ "$logged" == "2" ]] && grep -q "upstream=[0-9.]*ms" test_slow.log; then
+        pass "Every 2nd query logged with stage breakdown"
+        head -n 1 test_slow.log | sed 's/^/     /'
+    else
+        fail "Slow-query log incomplete (expected 2 entries, got '${logged}')"
+    fi
+else
+    fail "Could not start with tracing enabled"
+fi
+rm -f "test_slow.log"
+
+info "Testing -S without -t..."
+./dns -s 8.8.8.8 -p "$PROXY_PORT" -f "$FILTER_FILE" -S 2 > test_output.txt 2>&1 &
+TEST_PID=$!
+sleep 1
+if kill -0 "$TEST_PID" 2>/dev/null; then
+    kill "$TEST_PID" 2>/dev/null
+    wait "$TEST_PID" 2>/dev/null
+    fail "Should reject -S without -t"
+else
+    pass "Correctly rejected -S without -t"
+fi
+
+echo ""
+
+# ============================================================
+# TEST 17: Zero-Downtime Upgrade
+# ============================================================
+echo "======================================================================"
+echo "TEST 17: Listening Socket Handoff (-u socket_path)"
+echo "======================================================================"
+
+CONTROL_SOCKET="test_control.sock"
+echo "not a socket" > "$CONTROL_SOCKET"
+if ./dns -s 8.8.8.8 -p "$PROXY_PORT" -f "$FILTER_FILE" -u "$CONTROL_SOCKET" > test_output.txt 2>&1 ||
+   [[ ! -f "$CONTROL_SOCKET" ]]; then
+    fail "Should refuse to replace a regular file with the control socket"
+else
+    pass "Refused to replace a regular file with the control socket"
+fi
+rm -f "$CONTROL_SOCKET"
+if start_proxy "8.8.8.8" "$PROXY_PORT" "$FILTER_FILE" "-u $CONTROL_SOCKET"; then
+    OLD_PID=$PROXY_PID
+
+    if [[ "$(stat -c %a "$CONTROL_SOCKET")" == "600" ]]; then
+        pass "Control socket is accessible only by its owner (0600)"
+    else
+        fail "Control socket mode is $(stat -c %a "$CONTROL_SOCKET"), expected 600"
+    fi
+
+    info "Starting new instance that fails to open its slow-query log..."
+    ./dns -s 8.8.8.8 -p "$PROXY_PORT" -f "$FILTER_FILE" -u "$CONTROL_SOCKET" \
+        -t 0 -l /nonexistent/slow.log >> proxy.log 2>&1
+    sleep 0.5
+    if kill -0 "$OLD_PID" 2>/dev/null; then
+        pass "Old instance keeps serving when the new one fails to start"
+    else
+        fail "Old instance exited although the new one failed to start"
+    fi
+    check_dns "blocked.com" "A" "NXDOMAIN" "Old instance still answers"
+
+    info "Starting new instance while queries are running..."
+    (
+        for i in {1..20}; do
+            dig @"$PROXY_HOST" -p "$PROXY_PORT" blocked.com A +time=2 +tries=1 2>/dev/null | \
+                awk '/status:/{gsub(",", "", $6); print $6}'
+        done
+    ) > test_output.txt &
+    LOAD_PID=$!
+    sleep 0.5
+
+    ./dns -s 8.8.8.8 -p "$PROXY_PORT" -f "$FILTER_FILE" -u "$CONTROL_SOCKET" >> proxy.log 2>&1 &
+    PROXY_PID=$!
+    wait "$LOAD_PID"
+    sleep 1
+
+    if kill -0 "$OLD_PID" 2>/dev/null; then
+        fail "Old instance still running after handoff"
+        kill "$OLD_PID" 2>/dev/null
+    else
+        pass "Old instance exited after handing off its socket"
+    fi
+
+    answered=$(grep -c "NXDOMAIN" test_output.txt)
+    if [[ "$answered" == "20" ]]; then
+        pass "No queries lost during upgrade (20/20 answered)"
+    else
+        fail "Queries lost during upgrade ($answered/20 answered)"
+    fi
+
+    check_dns "blocked.com" "A" "NXDOMAIN" "New instance serves queries"
+    stop_proxy
+else
+    fail "Could not start with control socket"
+fi
+rm -f "$CONTROL_SOCKET"
+
+echo ""
+
 # ============================================================
 # Summary
 # ============================================================